@@ -46,6 +46,19 @@
 #define Dma3FillLarge16_(value, dest, size) Dma3FillLarge_(value, dest, size, 16)
 #define Dma3FillLarge32_(value, dest, size) Dma3FillLarge_(value, dest, size, 32)
 
+#ifdef DMA3_REQUEST_RING
+struct Dma3ManagerStats
+{
+    u32 mergedRequests;
+    u32 droppedRequests;
+    u16 bytesLastFrame;
+    u8 queueDepth; // requests left over after the last ProcessDma3Requests
+    u8 maxQueueDepth;
+};
+
+extern struct Dma3ManagerStats gDma3ManagerStats;
+#endif
+
 void ClearDma3Requests(void);
 void ProcessDma3Requests(void);
 s16 RequestDma3Copy(const void *src, void *dest, u16 size, u8 mode);
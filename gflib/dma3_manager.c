@@ -17,6 +17,8 @@ struct Dma3Request
     u32 value;
 };
 
+#ifndef DMA3_REQUEST_RING
+
 static struct Dma3Request sDma3Requests[MAX_DMA_REQUESTS];
 
 static vbool8 sDma3ManagerLocked;
@@ -55,8 +57,10 @@ void ProcessDma3Requests(void)
 
         if (bytesTransferred > 40 * 1024)
             return; // don't transfer more than 40 KiB
+#if !HEADLESS
         if (*(u8 *)REG_ADDR_VCOUNT > 224)
             return; // we're about to leave vblank, stop
+#endif
 
         switch (sDma3Requests[sDma3RequestCursor].mode)
         {
@@ -181,3 +185,190 @@ s16 CheckForSpaceForDma3Request(s16 index)
         return 0;
     }
 }
+
+#else
+
+// Ring of requests filled by the main loop and drained by the VBlank interrupt.
+// RequestDma3Copy/Fill only ever advance sDma3RingHead and ProcessDma3Requests
+// only advances sDma3RingTail, so VBlank no longer has to skip a frame because
+// the manager is locked. A new request is merged into the newest queued one when
+// it continues it, i.e. a fill of the same value or a copy from the adjacent
+// source. While merging, the producer flags the entry so that the consumer
+// leaves it for the next frame instead of transferring it with a half-updated
+// size.
+//
+// This relies on the consumer being an interrupt: it can preempt the producer,
+// but the producer never runs while it does. It is not safe with a consumer that
+// runs alongside the producer, e.g. on another thread, since nothing stops an
+// entry from being extended after the consumer has read its size.
+
+// Merging stops at this size so one request can't take up the frame's budget
+#define MAX_MERGED_REQUEST_SIZE 0x4000
+
+// The cast keeps cursor arithmetic like head - 1 wrapping within the u8 cursor
+#define RING_INDEX(cursor) ((u8)(cursor) % MAX_DMA_REQUESTS)
+
+static volatile struct Dma3Request sDma3Requests[MAX_DMA_REQUESTS];
+
+static vbool8 sDma3ManagerLocked;
+static vu8 sDma3RingHead;
+static vu8 sDma3RingTail;
+static vu8 sDma3MergingRequest;
+
+EWRAM_DATA struct Dma3ManagerStats gDma3ManagerStats = {0};
+
+void ClearDma3Requests(void)
+{
+    int i;
+
+    sDma3ManagerLocked = TRUE;
+    sDma3RingHead = 0;
+    sDma3RingTail = 0;
+    sDma3MergingRequest = FALSE;
+
+    for (i = 0; i < MAX_DMA_REQUESTS; i++)
+    {
+        sDma3Requests[i].size = 0;
+        sDma3Requests[i].src = NULL;
+        sDma3Requests[i].dest = NULL;
+    }
+
+    CpuFill32(0, &gDma3ManagerStats, sizeof(gDma3ManagerStats));
+    sDma3ManagerLocked = FALSE;
+}
+
+void ProcessDma3Requests(void)
+{
+    u16 bytesTransferred;
+    u8 tail;
+    volatile struct Dma3Request *request;
+
+    if (sDma3ManagerLocked)
+        return;
+
+    bytesTransferred = 0;
+    tail = sDma3RingTail;
+
+    while (tail != sDma3RingHead)
+    {
+        // The producer is extending the newest request, leave it for the next frame
+        if ((u8)(tail + 1) == sDma3RingHead && sDma3MergingRequest)
+            break;
+
+        request = &sDma3Requests[RING_INDEX(tail)];
+        if (bytesTransferred != 0 && bytesTransferred + request->size > 40 * 1024)
+            break; // don't transfer more than 40 KiB
+#if !HEADLESS
+        if (*(u8 *)REG_ADDR_VCOUNT > 224)
+            break; // we're about to leave vblank, stop
+#endif
+
+        bytesTransferred += request->size;
+
+        switch (request->mode)
+        {
+        case DMA_REQUEST_COPY32:
+            Dma3CopyLarge32_(request->src, request->dest, request->size);
+            break;
+        case DMA_REQUEST_FILL32:
+            Dma3FillLarge32_(request->value, request->dest, request->size);
+            break;
+        case DMA_REQUEST_COPY16:
+            Dma3CopyLarge16_(request->src, request->dest, request->size);
+            break;
+        case DMA_REQUEST_FILL16:
+            Dma3FillLarge16_(request->value, request->dest, request->size);
+            break;
+        }
+
+        request->size = 0;
+        sDma3RingTail = ++tail;
+    }
+
+    gDma3ManagerStats.bytesLastFrame = bytesTransferred;
+    gDma3ManagerStats.queueDepth = (u8)(sDma3RingHead - tail);
+}
+
+static bool32 CanMergeDma3Request(volatile struct Dma3Request *last, const u8 *src, u8 *dest, u16 size, u16 mode, u32 value)
+{
+    if (last->mode != mode || last->dest + last->size != dest)
+        return FALSE;
+    if (last->size + size > MAX_MERGED_REQUEST_SIZE)
+        return FALSE;
+    if (mode == DMA_REQUEST_COPY32 || mode == DMA_REQUEST_COPY16)
+        return last->src + last->size == src;
+    return last->value == value;
+}
+
+static s16 QueueDma3Request(const u8 *src, u8 *dest, u16 size, u16 mode, u32 value)
+{
+    u8 head = sDma3RingHead;
+    volatile struct Dma3Request *request;
+
+    if (head != sDma3RingTail)
+    {
+        request = &sDma3Requests[RING_INDEX(head - 1)];
+        if (CanMergeDma3Request(request, src, dest, size, mode, value))
+        {
+            // Only merge if the consumer didn't take the request before it saw the flag
+            sDma3MergingRequest = TRUE;
+            if (head != sDma3RingTail)
+            {
+                request->size += size;
+                sDma3MergingRequest = FALSE;
+                gDma3ManagerStats.mergedRequests++;
+                return RING_INDEX(head - 1);
+            }
+            sDma3MergingRequest = FALSE;
+        }
+    }
+
+    if ((u8)(head - sDma3RingTail) >= MAX_DMA_REQUESTS)
+    {
+        gDma3ManagerStats.droppedRequests++;
+        return -1; // the ring is full
+    }
+
+    request = &sDma3Requests[RING_INDEX(head)];
+    request->src = src;
+    request->dest = dest;
+    request->mode = mode;
+    request->value = value;
+    request->size = size;
+
+    // Publish the request only once it's complete
+    sDma3RingHead = head + 1;
+
+    if ((u8)(head + 1 - sDma3RingTail) > gDma3ManagerStats.maxQueueDepth)
+        gDma3ManagerStats.maxQueueDepth = (u8)(head + 1 - sDma3RingTail);
+
+    return RING_INDEX(head);
+}
+
+s16 RequestDma3Copy(const void *src, void *dest, u16 size, u8 mode)
+{
+    return QueueDma3Request(src, dest, size, mode == 1 ? DMA_REQUEST_COPY32 : DMA_REQUEST_COPY16, 0);
+}
+
+s16 RequestDma3Fill(s32 value, void *dest, u16 size, u8 mode)
+{
+    return QueueDma3Request(NULL, dest, size, mode == 1 ? DMA_REQUEST_FILL32 : DMA_REQUEST_FILL16, value);
+}
+
+s16 CheckForSpaceForDma3Request(s16 index)
+{
+    if (index == -1)  // check if all requests are free
+    {
+        if (sDma3RingHead != sDma3RingTail)
+            return -1;
+        return 0;
+    }
+    else  // check the specified request
+    {
+        if (sDma3Requests[index].size != 0)
+            return -1;
+        return 0;
+    }
+}
+
+#endif // DMA3_REQUEST_RING
@@ -1,8 +1,6 @@
 #include "global.h"
 #include "gpu_regs.h"
 
-#define GPU_REG_BUF_SIZE 0x60
-
 #define GPU_REG_BUF(offset) (*(u16 *)(&sGpuRegBuffer[offset]))
 #define GPU_REG(offset) (*(vu16 *)(REG_BASE + offset))
 
@@ -13,11 +11,86 @@ static u8 sGpuRegWaitingList[GPU_REG_BUF_SIZE];
 static volatile bool8 sGpuRegBufferLocked;
 static volatile bool8 sShouldSyncRegIE;
 static vu16 sRegIE;
+#if HEADLESS
+// Whether headless mode is hiding the current frame, and whether the forced
+// blank in REG_DISPCNT is only there for that rather than set by the game
+static bool8 sHeadlessHideFrame;
+static bool8 sHeadlessForcedBlank;
+#endif
+
+#ifdef GPU_REG_WRITE_LOG
+// The log for the frame in progress and the one for the last completed frame
+static EWRAM_DATA struct GpuRegWriteLog sGpuRegWriteLogs[2] = {0};
+static EWRAM_DATA u8 sGpuRegWriteLogId = 0;
+// What the registers were last set to through this file
+static EWRAM_DATA u16 sGpuRegShadow[GPU_REG_BUF_SIZE / 2] = {0};
+#endif
 
 static void CopyBufferedValueToGpuReg(u8 regOffset);
+static bool8 IsForcedBlank(void);
 static void SyncRegIE(void);
 static void UpdateRegDispstatIntrBits(u16 regIE);
 
+#ifdef GPU_REG_WRITE_LOG
+static void AddGpuRegWrite(u8 regOffset, u16 value)
+{
+    struct GpuRegWriteLog *log = &sGpuRegWriteLogs[sGpuRegWriteLogId];
+    u8 line = REG_VCOUNT & 0xFF;
+    s32 i;
+
+    sGpuRegShadow[regOffset / 2] = value;
+
+    for (i = log->count - 1; i >= 0 && log->writes[i].line == line; i--)
+    {
+        if (log->writes[i].regOffset == regOffset)
+        {
+            log->writes[i].value = value;
+            return;
+        }
+    }
+
+    if (log->count >= GPU_REG_WRITE_LOG_SIZE)
+    {
+        log->overflowed = TRUE;
+        return;
+    }
+
+    log->writes[log->count].line = line;
+    log->writes[log->count].regOffset = regOffset;
+    log->writes[log->count].value = value;
+    log->count++;
+}
+
+// SetGpuReg also writes registers directly from the main loop, where VBlank
+// could otherwise switch logs halfway through the write being added.
+static void LogGpuRegWrite(u8 regOffset, u16 value)
+{
+    u16 savedIme = REG_IME;
+
+    REG_IME = 0;
+    AddGpuRegWrite(regOffset, value);
+    REG_IME = savedIme;
+}
+
+static void StartGpuRegWriteLogFrame(void)
+{
+    struct GpuRegWriteLog *log;
+    u32 frame = sGpuRegWriteLogs[sGpuRegWriteLogId].frame;
+
+    sGpuRegWriteLogId ^= 1;
+    log = &sGpuRegWriteLogs[sGpuRegWriteLogId];
+    log->frame = frame + 1;
+    log->count = 0;
+    log->overflowed = FALSE;
+    CpuCopy16(sGpuRegShadow, log->initialRegs, sizeof(log->initialRegs));
+}
+
+const struct GpuRegWriteLog *GetGpuRegWriteLog(void)
+{
+    return &sGpuRegWriteLogs[sGpuRegWriteLogId ^ 1];
+}
+#endif
+
 void InitGpuRegManager(void)
 {
     s32 i;
@@ -35,11 +108,21 @@ void InitGpuRegManager(void)
 
 static void CopyBufferedValueToGpuReg(u8 regOffset)
 {
+#ifdef GPU_REG_WRITE_LOG
+    LogGpuRegWrite(regOffset, GPU_REG_BUF(regOffset));
+#endif
+
     if (regOffset == REG_OFFSET_DISPSTAT)
     {
         REG_DISPSTAT &= ~(DISPSTAT_HBLANK_INTR | DISPSTAT_VBLANK_INTR);
         REG_DISPSTAT |= GPU_REG_BUF(REG_OFFSET_DISPSTAT);
     }
+#if HEADLESS
+    else if (regOffset == REG_OFFSET_DISPCNT)
+    {
+        HideHeadlessFrame(sHeadlessHideFrame);
+    }
+#endif
     else
     {
         GPU_REG(regOffset) = GPU_REG_BUF(regOffset);
@@ -48,6 +131,10 @@ static void CopyBufferedValueToGpuReg(u8 regOffset)
 
 void CopyBufferedValuesToGpuRegs(void)
 {
+#ifdef GPU_REG_WRITE_LOG
+    StartGpuRegWriteLogFrame();
+#endif
+
     if (!sGpuRegBufferLocked)
     {
         s32 i;
@@ -72,7 +159,7 @@ void SetGpuReg(u8 regOffset, u16 value)
         GPU_REG_BUF(regOffset) = value;
         vcount = REG_VCOUNT & 0xFF;
 
-        if ((vcount >= 161 && vcount <= 225) || (REG_DISPCNT & DISPCNT_FORCED_BLANK))
+        if ((vcount >= 161 && vcount <= 225) || IsForcedBlank())
         {
             CopyBufferedValueToGpuReg(regOffset);
         }
@@ -103,7 +190,7 @@ void SetGpuReg_ForcedBlank(u8 regOffset, u16 value)
     {
         GPU_REG_BUF(regOffset) = value;
 
-        if (REG_DISPCNT & DISPCNT_FORCED_BLANK)
+        if (IsForcedBlank())
         {
             CopyBufferedValueToGpuReg(regOffset);
         }
@@ -128,6 +215,31 @@ void SetGpuReg_ForcedBlank(u8 regOffset, u16 value)
     }
 }
 
+static bool8 IsForcedBlank(void)
+{
+#if HEADLESS
+    if (sHeadlessForcedBlank)
+        return FALSE;
+#endif
+    return (REG_DISPCNT & DISPCNT_FORCED_BLANK) != 0;
+}
+
+#if HEADLESS
+// Keeps the display in forced blank on top of the game's own DISPCNT while a
+// frame is hidden. The game's writes are still buffered as if it were shown.
+void HideHeadlessFrame(bool8 hide)
+{
+    u16 dispCnt = GPU_REG_BUF(REG_OFFSET_DISPCNT);
+
+    sHeadlessHideFrame = hide;
+    sHeadlessForcedBlank = hide && !(dispCnt & DISPCNT_FORCED_BLANK);
+
+    if (hide)
+        dispCnt |= DISPCNT_FORCED_BLANK;
+    REG_DISPCNT = dispCnt;
+}
+#endif
+
 u16 GetGpuReg(u8 regOffset)
 {
     if (regOffset == REG_OFFSET_DISPSTAT)
@@ -3,6 +3,34 @@
 
 // Exported type declarations
 
+#define GPU_REG_BUF_SIZE 0x60
+
+#ifdef GPU_REG_WRITE_LOG
+#define GPU_REG_WRITE_LOG_SIZE 128
+
+struct GpuRegWrite
+{
+    u8 line; // VCOUNT when the write reached the register
+    u8 regOffset;
+    u16 value;
+};
+
+// The register writes made through SetGpuReg in one frame, starting from the
+// VBlank flush. These all land in VBlank or forced blank; writes that HBlank
+// callbacks and scanline effect DMA make directly to the registers are not
+// listed, so this is not the register state per scanline. Replaying the writes
+// in order over initialRegs gives the state the frame was drawn with. Writes
+// made on the same scanline collapse into one per register.
+struct GpuRegWriteLog
+{
+    u32 frame;
+    u16 count;
+    bool8 overflowed;
+    u16 initialRegs[GPU_REG_BUF_SIZE / 2];
+    struct GpuRegWrite writes[GPU_REG_WRITE_LOG_SIZE];
+};
+#endif
+
 // Exported RAM declarations
 
 // Exported ROM declarations
@@ -15,5 +43,11 @@ void SetGpuRegBits(u8 regOffset, u16 mask);
 void ClearGpuRegBits(u8 regOffset, u16 mask);
 void EnableInterrupts(u16 mask);
 void DisableInterrupts(u16 mask);
+#ifdef GPU_REG_WRITE_LOG
+const struct GpuRegWriteLog *GetGpuRegWriteLog(void);
+#endif
+#if HEADLESS
+void HideHeadlessFrame(bool8 hide);
+#endif
 
 #endif //GUARD_GPU_REGS_H
@@ -1,5 +1,6 @@
 #include "global.h"
 #include "sprite.h"
+#include "frame_trace.h"
 #include "main.h"
 #include "palette.h"
 
@@ -310,6 +311,7 @@ void ResetSpriteData(void)
 void AnimateSprites(void)
 {
     u8 i;
+    TRACE_BEGIN(TRACE_ANIMATE_SPRITES);
     for (i = 0; i < MAX_SPRITES; i++)
     {
         struct Sprite *sprite = &gSprites[i];
@@ -322,11 +324,13 @@ void AnimateSprites(void)
                 AnimateSprite(sprite);
         }
     }
+    TRACE_END(TRACE_ANIMATE_SPRITES);
 }
 
 void BuildOamBuffer(void)
 {
     u8 temp;
+    TRACE_BEGIN(TRACE_BUILD_OAM_BUFFER);
     UpdateOamCoords();
     BuildSpritePriorities();
     SortSprites();
@@ -336,6 +340,7 @@ void BuildOamBuffer(void)
     CopyMatricesToOamBuffer();
     gMain.oamLoadDisabled = temp;
     sShouldProcessSpriteCopyRequests = TRUE;
+    TRACE_END(TRACE_BUILD_OAM_BUFFER);
 }
 
 void UpdateOamCoords(void)
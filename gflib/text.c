@@ -12,6 +12,7 @@
 #include "menu.h"
 #include "dynamic_placeholder_text_util.h"
 #include "fonts.h"
+#include "frame_trace.h"
 
 static u16 RenderText(struct TextPrinter *);
 static u32 RenderFont(struct TextPrinter *);
@@ -320,6 +321,7 @@ void RunTextPrinters(void)
 {
     int i;
 
+    TRACE_BEGIN(TRACE_RUN_TEXT_PRINTERS);
     if (!gDisableTextPrinters)
     {
         for (i = 0; i < WINDOWS_MAX; ++i)
@@ -342,6 +344,7 @@ void RunTextPrinters(void)
             }
         }
     }
+    TRACE_END(TRACE_RUN_TEXT_PRINTERS);
 }
 
 bool16 IsTextPrinterActive(u8 id)
@@ -0,0 +1,98 @@
+#include "global.h"
+#include "vram_dirty.h"
+
+// Records which VRAM tiles have been written since a renderer last consumed
+// the bitmap, so that anything it derived from tile data (expanded or flipped
+// copies of 4bpp and 8bpp tiles) only has to be rebuilt for the tiles that
+// actually changed. Writes are reported by the CpuCopy/CpuFill and DmaCopy/
+// DmaFill macros, the VRAM decompressors, and through those by the DMA3
+// manager (LoadBgTiles, RequestDma3Copy) and the sprite copy queue.
+
+#ifdef VRAM_DIRTY_TRACKING
+
+EWRAM_DATA u32 gVramDirtyTiles[NUM_VRAM_DIRTY_TILES / 32] = {0};
+EWRAM_DATA struct VramDirtyStats gVramDirtyStats = {0};
+
+void MarkVramDirty(const void *dest, u32 size)
+{
+    u32 offset = (u32)dest - VRAM;
+    u32 first, last;
+    u32 firstWord, lastWord;
+    u32 firstMask, lastMask;
+    u32 i;
+    u16 ime;
+
+    if (offset >= VRAM_SIZE || size == 0)
+        return;
+    if (size > VRAM_SIZE - offset)
+        size = VRAM_SIZE - offset;
+
+    first = offset / VRAM_DIRTY_TILE_SIZE;
+    last = (offset + size - 1) / VRAM_DIRTY_TILE_SIZE;
+    firstWord = first / 32;
+    lastWord = last / 32;
+    firstMask = 0xFFFFFFFF << (first % 32);
+    lastMask = 0xFFFFFFFF >> (31 - (last % 32));
+
+    // Copies are made from both the main loop and VBlank
+    ime = REG_IME;
+    REG_IME = 0;
+
+    if (firstWord == lastWord)
+    {
+        gVramDirtyTiles[firstWord] |= firstMask & lastMask;
+    }
+    else
+    {
+        gVramDirtyTiles[firstWord] |= firstMask;
+        for (i = firstWord + 1; i < lastWord; i++)
+            gVramDirtyTiles[i] = 0xFFFFFFFF;
+        gVramDirtyTiles[lastWord] |= lastMask;
+    }
+
+    gVramDirtyStats.writes++;
+    gVramDirtyStats.invalidatedTiles += last - first + 1;
+
+    REG_IME = ime;
+}
+
+// Both decompressors share the LZ77 header, with the output size in bytes 1-3.
+void TrackedLZ77UnCompVram(const u32 *src, void *dest)
+{
+#if FAST_LZ
+    FastLZUnCompVram(src, dest);
+#else
+    (LZ77UnCompVram)(src, dest);
+#endif
+    MarkVramDirty(dest, *src >> 8);
+}
+
+void TrackedRLUnCompVram(const void *src, void *dest)
+{
+    (RLUnCompVram)(src, dest);
+    MarkVramDirty(dest, *(const u32 *)src >> 8);
+}
+
+bool32 IsVramTileDirty(u32 tileId)
+{
+    if (tileId >= NUM_VRAM_DIRTY_TILES)
+        return FALSE;
+    return (gVramDirtyTiles[tileId / 32] >> (tileId % 32)) & 1;
+}
+
+void ClearVramDirtyTiles(void)
+{
+    u16 ime = REG_IME;
+
+    REG_IME = 0;
+    CpuFill32(0, gVramDirtyTiles, sizeof(gVramDirtyTiles));
+    REG_IME = ime;
+}
+
+void ResetVramDirtyStats(void)
+{
+    gVramDirtyStats.writes = 0;
+    gVramDirtyStats.invalidatedTiles = 0;
+}
+
+#endif // VRAM_DIRTY_TRACKING
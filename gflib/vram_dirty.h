@@ -0,0 +1,27 @@
+#ifndef GUARD_VRAM_DIRTY_H
+#define GUARD_VRAM_DIRTY_H
+
+#ifdef VRAM_DIRTY_TRACKING
+
+// Tracking is done per 4bpp tile, so an 8bpp tile covers two bits.
+#define VRAM_DIRTY_TILE_SIZE 32
+#define NUM_VRAM_DIRTY_TILES (VRAM_SIZE / VRAM_DIRTY_TILE_SIZE)
+
+struct VramDirtyStats
+{
+    u32 writes;           // VRAM writes seen since the last ResetVramDirtyStats
+    u32 invalidatedTiles; // tiles covered by those writes, counting repeats
+};
+
+extern u32 gVramDirtyTiles[NUM_VRAM_DIRTY_TILES / 32];
+extern struct VramDirtyStats gVramDirtyStats;
+
+// MarkVramDirty and the Tracked*UnCompVram wrappers are declared in gba/syscall.h
+// so that the CPU and DMA copy macros can use them.
+bool32 IsVramTileDirty(u32 tileId);
+void ClearVramDirtyTiles(void);
+void ResetVramDirtyStats(void);
+
+#endif // VRAM_DIRTY_TRACKING
+
+#endif // GUARD_VRAM_DIRTY_H
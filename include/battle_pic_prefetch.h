@@ -0,0 +1,13 @@
+#ifndef GUARD_BATTLE_PIC_PREFETCH_H
+#define GUARD_BATTLE_PIC_PREFETCH_H
+
+#ifdef BATTLE_PIC_PREFETCH
+
+void PrefetchOpponentBattlePics(void);
+bool8 TryLoadPrefetchedBattlePic(u16 species, u32 personality, void *dest);
+bool8 TryLoadPrefetchedBattlePalette(const u32 *lzPaletteData, void *dest);
+void FreeBattlePicPrefetch(void);
+
+#endif // BATTLE_PIC_PREFETCH
+
+#endif // GUARD_BATTLE_PIC_PREFETCH_H
@@ -55,4 +55,50 @@
 #endif
 #endif
 
+// Optional engine features. Enabling any of these changes the generated code,
+// so the result will no longer match the original ROM.
+
+// Uncomment to decode the opponent's battle pics and palettes ahead of time, during
+// the battle transition or intro, instead of when their sprites are first loaded.
+//#define BATTLE_PIC_PREFETCH
+
+// Uncomment to queue DMA3 requests in a ring that VBlank can drain without the
+// manager being locked, which merges contiguous requests and keeps statistics in
+// gDma3ManagerStats. See gflib/dma3_manager.c.
+//#define DMA3_REQUEST_RING
+
+// Uncomment to keep a per-frame list of the buffered register writes made through
+// gflib/gpu_regs.c. Mid-frame writes from HBlank callbacks and scanline effects
+// are not included. See GetGpuRegWriteLog.
+//#define GPU_REG_WRITE_LOG
+
+// Uncomment to publish each frame's scanline effect values in
+// gScanlineEffectFrameTable, so a renderer can apply them without HBlank DMA.
+//#define SCANLINE_EFFECT_FRAME_TABLE
+
+// Uncomment to record which VRAM tiles were written since a renderer last
+// cleared gVramDirtyTiles, so it can cache decoded tiles. See gflib/vram_dirty.c.
+//#define VRAM_DIRTY_TRACKING
+
+// Uncomment to trace the phases of each frame and print the trace as Chrome
+// trace event JSON when a frame overruns. Requires printf debugging, see above.
+//#define FRAME_TRACE
+
+// Uncomment one of these to record the key input, RNG seed, RTC probe and RTC
+// reads of a playthrough through DebugPrintf, or to replay data/input_replay.bin.
+// See src/input_replay.c.
+//#define INPUT_RECORD
+//#define INPUT_REPLAY
+
+// The m4a sound engine's switches are in include/gba/m4a_config.h.
+
+// Headless builds (make HEADLESS=1) run the main loop without waiting for
+// VBlank. Every HEADLESS_RENDER_INTERVAL-th frame is displayed (0 for none), and
+// the frame rate is printed through DebugPrintf every HEADLESS_REPORT_INTERVAL
+// frames and on soft reset.
+#if HEADLESS
+#define HEADLESS_RENDER_INTERVAL 0
+#define HEADLESS_REPORT_INTERVAL 3600
+#endif
+
 #endif // GUARD_CONFIG_H
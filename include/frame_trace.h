@@ -0,0 +1,28 @@
+#ifndef GUARD_FRAME_TRACE_H
+#define GUARD_FRAME_TRACE_H
+
+enum {
+    TRACE_CALLBACKS,
+    TRACE_RUN_TASKS,
+    TRACE_ANIMATE_SPRITES,
+    TRACE_BUILD_OAM_BUFFER,
+    TRACE_RUN_TEXT_PRINTERS,
+    TRACE_UPDATE_PALETTE_FADE,
+    TRACE_VBLANK,
+    TRACE_PROCESS_DMA3_REQUESTS,
+    TRACE_PHASE_COUNT,
+};
+
+#ifdef FRAME_TRACE
+#define TRACE_BEGIN(phase) RecordFrameTraceEvent(phase, TRUE)
+#define TRACE_END(phase) RecordFrameTraceEvent(phase, FALSE)
+
+void RecordFrameTraceEvent(u8 phase, bool8 begin);
+void FrameTraceEndFrame(void);
+void DumpFrameTrace(void);
+#else
+#define TRACE_BEGIN(phase)
+#define TRACE_END(phase)
+#endif // FRAME_TRACE
+
+#endif // GUARD_FRAME_TRACE_H
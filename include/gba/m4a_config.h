@@ -0,0 +1,17 @@
+#ifndef GUARD_GBA_M4A_CONFIG_H
+#define GUARD_GBA_M4A_CONFIG_H
+
+// Switches for the m4a sound engine. They live apart from include/config.h so
+// that src/m4a.c, which does not include global.h, picks them up without also
+// getting UBFIX and the other game-wide settings.
+
+// Uncomment to look up note frequencies in a precomputed per-key table in
+// MidiKeyToFreq. The resulting pitches are identical.
+//#define M4A_KEY_FREQ_TABLE
+
+// Uncomment to stop releasing DirectSound voices once they are silent, and the
+// quietest ones while more than this many voices are active. Statistics are
+// kept in gM4AVoiceStats.
+//#define M4A_VOICE_BUDGET 8
+
+#endif // GUARD_GBA_M4A_CONFIG_H
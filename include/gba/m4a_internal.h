@@ -1,6 +1,7 @@
 #ifndef GUARD_GBA_M4A_INTERNAL_H
 #define GUARD_GBA_M4A_INTERNAL_H
 
+#include "gba/m4a_config.h"
 #include "gba/gba.h"
 
 // ASCII encoding of 'Smsh' in reverse
@@ -168,6 +169,19 @@ struct SoundChannel
 
 #define PCM_DMA_BUF_SIZE 1584 // size of Direct Sound buffer
 
+#ifdef M4A_VOICE_BUDGET
+struct M4AVoiceStats
+{
+    u32 retiredVoices;    // releasing voices stopped before the mixer got to them
+    u32 stolenVoices;     // held voices taken over by a new note
+    u32 mixedVoiceFrames; // sum of the voices mixed in each frame
+    u8 activeVoices;      // voices mixed in the last frame
+    u8 maxActiveVoices;
+};
+
+extern struct M4AVoiceStats gM4AVoiceStats;
+#endif
+
 struct MusicPlayerInfo;
 
 typedef void (*MPlayFunc)();
@@ -389,6 +403,9 @@ extern struct CgbChannel gCgbChans[];
 
 extern const u8 gScaleTable[];
 extern const u32 gFreqTable[];
+#ifdef M4A_KEY_FREQ_TABLE
+extern const u32 gKeyFreqTable[];
+#endif
 extern const u16 gPcmSamplesPerVBlankTable[];
 
 extern const u8 gCgbScaleTable[];
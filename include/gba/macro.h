@@ -1,6 +1,21 @@
 #ifndef GUARD_GBA_MACRO_H
 #define GUARD_GBA_MACRO_H
 
+// With VRAM_DIRTY_TRACKING, the fill and copy macros also pass their
+// destination to MarkVramDirty. They bind dest and size to locals first so that
+// each argument is still evaluated only once.
+#ifdef VRAM_DIRTY_TRACKING
+#define CPU_FILL_UNCHECKED(value, dest, size, bit)                                            \
+{                                                                                   \
+    vu##bit tmp = (vu##bit)(value);                                                 \
+    void *trackedDest = (void *)(dest);                                             \
+    u32 trackedSize = (size);                                                       \
+    CpuSet((void *)&tmp,                                                            \
+           trackedDest,                                                             \
+           CPU_SET_##bit##BIT | CPU_SET_SRC_FIXED | (trackedSize/(bit/8) & 0x1FFFFF)); \
+    MarkVramDirty(trackedDest, trackedSize);                                        \
+}
+#else
 #define CPU_FILL_UNCHECKED(value, dest, size, bit)                                          \
 {                                                                                 \
     vu##bit tmp = (vu##bit)(value);                                               \
@@ -8,6 +23,7 @@
            dest,                                                                  \
            CPU_SET_##bit##BIT | CPU_SET_SRC_FIXED | ((size)/(bit/8) & 0x1FFFFF)); \
 }
+#endif
 
 #if MODERN
 #define CPU_FILL(value, dest, size, bit) \
@@ -23,7 +39,18 @@
 #define CpuFill16(value, dest, size) CPU_FILL(value, dest, size, 16)
 #define CpuFill32(value, dest, size) CPU_FILL(value, dest, size, 32)
 
+#ifdef VRAM_DIRTY_TRACKING
+#define CPU_COPY_UNCHECKED(src, dest, size, bit) \
+    do \
+    { \
+        void *trackedDest = (void *)(dest); \
+        u32 trackedSize = (size); \
+        CpuSet(src, trackedDest, CPU_SET_##bit##BIT | (trackedSize/(bit/8) & 0x1FFFFF)); \
+        MarkVramDirty(trackedDest, trackedSize); \
+    } while (0)
+#else
 #define CPU_COPY_UNCHECKED(src, dest, size, bit) CpuSet(src, dest, CPU_SET_##bit##BIT | ((size)/(bit/8) & 0x1FFFFF))
+#endif
 
 #if MODERN
 #define CPU_COPY(src, dest, size, bit) \
@@ -40,6 +67,18 @@
 #define CpuCopy16(src, dest, size) CPU_COPY(src, dest, size, 16)
 #define CpuCopy32(src, dest, size) CPU_COPY(src, dest, size, 32)
 
+#ifdef VRAM_DIRTY_TRACKING
+#define CpuFastFill(value, dest, size)                                 \
+{                                                                      \
+    vu32 tmp = (vu32)(value);                                          \
+    void *trackedDest = (void *)(dest);                                \
+    u32 trackedSize = (size);                                          \
+    CpuFastSet((void *)&tmp,                                           \
+               trackedDest,                                            \
+               CPU_FAST_SET_SRC_FIXED | (trackedSize/(32/8) & 0x1FFFFF)); \
+    MarkVramDirty(trackedDest, trackedSize);                           \
+}
+#else
 #define CpuFastFill(value, dest, size)                               \
 {                                                                    \
     vu32 tmp = (vu32)(value);                                        \
@@ -47,12 +86,24 @@
                dest,                                                 \
                CPU_FAST_SET_SRC_FIXED | ((size)/(32/8) & 0x1FFFFF)); \
 }
+#endif
 
 #define CpuFastFill16(value, dest, size) CpuFastFill(((value) << 16) | (value), (dest), (size))
 
 #define CpuFastFill8(value, dest, size) CpuFastFill(((value) << 24) | ((value) << 16) | ((value) << 8) | (value), (dest), (size))
 
+#ifdef VRAM_DIRTY_TRACKING
+#define CpuFastCopy(src, dest, size) \
+    do \
+    { \
+        void *trackedDest = (void *)(dest); \
+        u32 trackedSize = (size); \
+        CpuFastSet(src, trackedDest, (trackedSize/(32/8) & 0x1FFFFF)); \
+        MarkVramDirty(trackedDest, trackedSize); \
+    } while (0)
+#else
 #define CpuFastCopy(src, dest, size) CpuFastSet(src, dest, ((size)/(32/8) & 0x1FFFFF))
+#endif
 
 #define DmaSetUnchecked(dmaNum, src, dest, control) \
 {                                                 \
@@ -77,6 +128,20 @@
     DmaSetUnchecked(dmaNum, src, dest, control)
 #endif
 
+#ifdef VRAM_DIRTY_TRACKING
+#define DMA_FILL_UNCHECKED(dmaNum, value, dest, size, bit)                                    \
+{                                                                                             \
+    vu##bit tmp = (vu##bit)(value);                                                           \
+    void *trackedDest = (void *)(dest);                                                       \
+    u32 trackedSize = (size);                                                                 \
+    DmaSet(dmaNum,                                                                            \
+           &tmp,                                                                              \
+           trackedDest,                                                                       \
+           (DMA_ENABLE | DMA_START_NOW | DMA_##bit##BIT | DMA_SRC_FIXED | DMA_DEST_INC) << 16 \
+         | (trackedSize/(bit/8)));                                                            \
+    MarkVramDirty(trackedDest, trackedSize);                                                  \
+}
+#else
 #define DMA_FILL_UNCHECKED(dmaNum, value, dest, size, bit)                                    \
 {                                                                                             \
     vu##bit tmp = (vu##bit)(value);                                                           \
@@ -86,6 +151,7 @@
            (DMA_ENABLE | DMA_START_NOW | DMA_##bit##BIT | DMA_SRC_FIXED | DMA_DEST_INC) << 16 \
          | ((size)/(bit/8)));                                                                 \
 }
+#endif
 
 #if MODERN
 #define DMA_FILL(dmaNum, value, dest, size, bit) \
@@ -127,12 +193,27 @@
 #define DmaClear16(dmaNum, dest, size) DMA_CLEAR(dmaNum, dest, size, 16)
 #define DmaClear32(dmaNum, dest, size) DMA_CLEAR(dmaNum, dest, size, 32)
 
+#ifdef VRAM_DIRTY_TRACKING
+#define DMA_COPY_UNCHECKED(dmaNum, src, dest, size, bit)                                        \
+    do                                                                                          \
+    {                                                                                           \
+        void *trackedDest = (void *)(dest);                                                     \
+        u32 trackedSize = (size);                                                               \
+        DmaSet(dmaNum,                                                                          \
+               src,                                                                             \
+               trackedDest,                                                                     \
+               (DMA_ENABLE | DMA_START_NOW | DMA_##bit##BIT | DMA_SRC_INC | DMA_DEST_INC) << 16 \
+             | (trackedSize/(bit/8)));                                                          \
+        MarkVramDirty(trackedDest, trackedSize);                                                \
+    } while (0)
+#else
 #define DMA_COPY_UNCHECKED(dmaNum, src, dest, size, bit)                                    \
     DmaSet(dmaNum,                                                                          \
            src,                                                                             \
            dest,                                                                            \
            (DMA_ENABLE | DMA_START_NOW | DMA_##bit##BIT | DMA_SRC_INC | DMA_DEST_INC) << 16 \
          | ((size)/(bit/8)))
+#endif
 
 #if MODERN
 #define DMA_COPY(dmaNum, src, dest, size, bit) \
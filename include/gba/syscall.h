@@ -61,10 +61,30 @@ void LZ77UnCompWram(const u32 *src, void *dest);
 
 void LZ77UnCompVram(const u32 *src, void *dest);
 
+#if FAST_LZ
+// Compressed assets are built with gbagfx's LZ4-style codec instead, which
+// is decoded in software. See src/decompress.c.
+void FastLZUnCompWram(const u32 *src, void *dest);
+void FastLZUnCompVram(const u32 *src, void *dest);
+#define LZ77UnCompWram(src, dest) FastLZUnCompWram(src, dest)
+#define LZ77UnCompVram(src, dest) FastLZUnCompVram(src, dest)
+#endif
+
 void RLUnCompWram(const void *src, void *dest);
 
 void RLUnCompVram(const void *src, void *dest);
 
+#ifdef VRAM_DIRTY_TRACKING
+// Writes to VRAM are recorded per tile. The copy macros in gba/macro.h report
+// theirs through MarkVramDirty. See gflib/vram_dirty.c.
+void MarkVramDirty(const void *dest, u32 size);
+void TrackedLZ77UnCompVram(const u32 *src, void *dest);
+void TrackedRLUnCompVram(const void *src, void *dest);
+#undef LZ77UnCompVram
+#define LZ77UnCompVram(src, dest) TrackedLZ77UnCompVram(src, dest)
+#define RLUnCompVram(src, dest) TrackedRLUnCompVram(src, dest)
+#endif
+
 int MultiBoot(struct MultiBootParam *mp);
 
 s32 Div(s32 num, s32 denom);
@@ -0,0 +1,30 @@
+#ifndef GUARD_INPUT_REPLAY_H
+#define GUARD_INPUT_REPLAY_H
+
+#if defined(INPUT_RECORD) && defined(INPUT_REPLAY)
+#error "INPUT_RECORD and INPUT_REPLAY cannot be used together"
+#endif
+
+#if defined(INPUT_RECORD) || defined(INPUT_REPLAY)
+#define INPUT_LOGGING
+
+enum {
+    INPUT_EVENT_REPEAT, // extends the previous key run by value frames
+    INPUT_EVENT_RNG_SEED,
+    INPUT_EVENT_RTC_DATE,
+    INPUT_EVENT_RTC_TIME,
+    INPUT_EVENT_RTC_PROBE,
+};
+
+struct SiiRtcInfo;
+
+u16 RecordOrReplayKeys(u16 keys);
+u32 RecordOrReplayEvent(u8 type, u32 value);
+void RecordOrReplayRtc(struct SiiRtcInfo *rtc);
+#endif
+
+#ifdef INPUT_RECORD
+void FlushInputRecording(void);
+#endif
+
+#endif // GUARD_INPUT_REPLAY_H
@@ -35,6 +35,20 @@ struct ScanlineEffect
     u8 waveTaskId;
 };
 
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+// The per-scanline register values for the frame about to be displayed, published on
+// every VBlank so a renderer can apply the whole effect at once.
+struct ScanlineEffectFrameTable
+{
+    const void *values; // one value per scanline, starting with the first
+    u16 regOffset;
+    u8 valueSize;
+    bool8 active;
+};
+
+extern struct ScanlineEffectFrameTable gScanlineEffectFrameTable;
+#endif
+
 extern struct ScanlineEffect gScanlineEffect;
 
 extern u16 ALIGNED(4) gScanlineEffectRegBuffers[2][0x3C0];
@@ -43,6 +57,9 @@ void ScanlineEffect_Stop(void);
 void ScanlineEffect_Clear(void);
 void ScanlineEffect_SetParams(struct ScanlineEffectParams);
 void ScanlineEffect_InitHBlankDmaTransfer(void);
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+void ScanlineEffect_SetFrameTableConsumer(bool8 hasConsumer);
+#endif
 u8 ScanlineEffect_InitWave(u8 startLine, u8 endLine, u8 frequency, u8 amplitude, u8 delayInterval, u8 regOffset, bool8 applyBattleBgOffsets);
 
 #endif // GUARD_SCANLINE_EFFECT_H
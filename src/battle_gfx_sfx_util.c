@@ -5,6 +5,7 @@
 #include "battle_anim.h"
 #include "constants/battle_anim.h"
 #include "battle_interface.h"
+#include "battle_pic_prefetch.h"
 #include "main.h"
 #include "dma3.h"
 #include "malloc.h"
@@ -597,6 +598,9 @@ void BattleLoadOpponentMonSpriteGfx(struct Pokemon *mon, u8 battlerId)
 
     otId = GetMonData(mon, MON_DATA_OT_ID);
     position = GetBattlerPosition(battlerId);
+#ifdef BATTLE_PIC_PREFETCH
+    if (!TryLoadPrefetchedBattlePic(species, currentPersonality, gMonSpritesGfxPtr->sprites.ptr[position]))
+#endif
     HandleLoadSpecialPokePic_DontHandleDeoxys(&gMonFrontPicTable[species],
                                               gMonSpritesGfxPtr->sprites.ptr[position],
                                               species, currentPersonality);
@@ -608,6 +612,9 @@ void BattleLoadOpponentMonSpriteGfx(struct Pokemon *mon, u8 battlerId)
     else
         lzPaletteData = GetMonSpritePalFromSpeciesAndPersonality(species, otId, monsPersonality);
 
+#ifdef BATTLE_PIC_PREFETCH
+    if (!TryLoadPrefetchedBattlePalette(lzPaletteData, gDecompressionBuffer))
+#endif
     LZDecompressWram(lzPaletteData, gDecompressionBuffer);
     LoadPalette(gDecompressionBuffer, paletteOffset, PLTT_SIZE_4BPP);
     LoadPalette(gDecompressionBuffer, BG_PLTT_ID(8) + BG_PLTT_ID(battlerId), PLTT_SIZE_4BPP);
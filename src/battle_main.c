@@ -7,6 +7,7 @@
 #include "battle_interface.h"
 #include "battle_main.h"
 #include "battle_message.h"
+#include "battle_pic_prefetch.h"
 #include "battle_pyramid.h"
 #include "battle_scripts.h"
 #include "battle_setup.h"
@@ -698,6 +699,10 @@ static void CB2_InitBattleInternal(void)
         if (gBattleTypeFlags & BATTLE_TYPE_TWO_OPPONENTS)
             CreateNPCTrainerParty(&gEnemyParty[PARTY_SIZE / 2], gTrainerBattleOpponent_B, FALSE);
         SetWildMonHeldItem();
+#ifdef BATTLE_PIC_PREFETCH
+        if (gBattleTypeFlags & BATTLE_TYPE_TRAINER)
+            PrefetchOpponentBattlePics();
+#endif
     }
 
     gMain.inBattle = TRUE;
@@ -1088,6 +1093,9 @@ static void CB2_HandleStartBattle(void)
             TryCorrectShedinjaLanguage(&gEnemyParty[3]);
             TryCorrectShedinjaLanguage(&gEnemyParty[4]);
             TryCorrectShedinjaLanguage(&gEnemyParty[5]);
+#ifdef BATTLE_PIC_PREFETCH
+            PrefetchOpponentBattlePics();
+#endif
             gBattleCommunication[MULTIUSE_STATE]++;
         }
         break;
@@ -0,0 +1,181 @@
+#include "global.h"
+#include "battle.h"
+#include "battle_pic_prefetch.h"
+#include "data.h"
+#include "decompress.h"
+#include "main.h"
+#include "malloc.h"
+#include "pokemon.h"
+#include "task.h"
+
+// Decodes the front pics and palettes of the opponent's lead Pokémon ahead of
+// time, so that the battle controllers can copy them out instead of
+// decompressing them on the frame the sprites are created. Wild and scripted
+// opponents are queued when the battle transition starts. Trainer parties are
+// only created once the battle has been set up, so their pics are decoded
+// during the battle intro, and link opponents once the party exchange is done.
+// One pic is decoded per frame to keep the screen smooth. Anything that was
+// not finished in time is simply decompressed by the loaders as before.
+
+#ifdef BATTLE_PIC_PREFETCH
+
+#define NUM_PREFETCHED_PICS (MAX_BATTLERS_COUNT / 2)
+
+// Frames to keep prefetched pics around outside of battle before freeing them.
+#define PREFETCH_TIMEOUT 300
+
+enum {
+    PREFETCH_EMPTY,
+    PREFETCH_PENDING,
+    PREFETCH_READY,
+};
+
+struct PrefetchedBattlePic
+{
+    u8 *gfx;
+    u8 *palette;
+    const u32 *lzPalette;
+    u32 personality;
+    u16 species;
+    u8 state;
+};
+
+static void Task_PrefetchBattlePics(u8 taskId);
+
+static EWRAM_DATA struct PrefetchedBattlePic sPrefetchedPics[NUM_PREFETCHED_PICS] = {0};
+
+#define tTimer data[0]
+
+static void QueuePrefetch(struct Pokemon *mon)
+{
+    u32 i;
+    u16 species = GetMonData(mon, MON_DATA_SPECIES);
+
+    if (species == SPECIES_NONE || species >= NUM_SPECIES)
+        return;
+
+    for (i = 0; i < NUM_PREFETCHED_PICS; i++)
+    {
+        if (sPrefetchedPics[i].state == PREFETCH_EMPTY)
+        {
+            sPrefetchedPics[i].species = species;
+            sPrefetchedPics[i].personality = GetMonData(mon, MON_DATA_PERSONALITY);
+            sPrefetchedPics[i].lzPalette = GetMonFrontSpritePal(mon);
+            sPrefetchedPics[i].state = PREFETCH_PENDING;
+            return;
+        }
+    }
+}
+
+void PrefetchOpponentBattlePics(void)
+{
+    FreeBattlePicPrefetch();
+
+    QueuePrefetch(&gEnemyParty[0]);
+    if (gBattleTypeFlags & BATTLE_TYPE_TWO_OPPONENTS)
+        QueuePrefetch(&gEnemyParty[PARTY_SIZE / 2]);
+    else if (gBattleTypeFlags & BATTLE_TYPE_DOUBLE)
+        QueuePrefetch(&gEnemyParty[1]);
+
+    if (sPrefetchedPics[0].state == PREFETCH_PENDING)
+        CreateTask(Task_PrefetchBattlePics, 0);
+}
+
+static void DecodePrefetchedPic(struct PrefetchedBattlePic *pic)
+{
+    pic->gfx = Alloc(GetDecompressedDataSize(gMonFrontPicTable[pic->species].data));
+    pic->palette = Alloc(GetDecompressedDataSize(pic->lzPalette));
+
+    if (pic->gfx == NULL || pic->palette == NULL)
+    {
+        TRY_FREE_AND_SET_NULL(pic->gfx);
+        TRY_FREE_AND_SET_NULL(pic->palette);
+        pic->state = PREFETCH_EMPTY;
+        return;
+    }
+
+    HandleLoadSpecialPokePic_DontHandleDeoxys(&gMonFrontPicTable[pic->species], pic->gfx, pic->species, pic->personality);
+    LZDecompressWram(pic->lzPalette, pic->palette);
+    pic->state = PREFETCH_READY;
+}
+
+static void Task_PrefetchBattlePics(u8 taskId)
+{
+    u32 i;
+
+    for (i = 0; i < NUM_PREFETCHED_PICS; i++)
+    {
+        if (sPrefetchedPics[i].state == PREFETCH_PENDING)
+        {
+            DecodePrefetchedPic(&sPrefetchedPics[i]);
+            return;
+        }
+    }
+
+    // Battle setup resets the tasks, so this only runs out if no battle followed.
+    if (!gMain.inBattle && ++gTasks[taskId].tTimer > PREFETCH_TIMEOUT)
+        FreeBattlePicPrefetch();
+}
+
+static void TryClearPrefetchedPic(struct PrefetchedBattlePic *pic)
+{
+    if (pic->gfx == NULL && pic->palette == NULL)
+        pic->state = PREFETCH_EMPTY;
+}
+
+bool8 TryLoadPrefetchedBattlePic(u16 species, u32 personality, void *dest)
+{
+    u32 i;
+
+    for (i = 0; i < NUM_PREFETCHED_PICS; i++)
+    {
+        struct PrefetchedBattlePic *pic = &sPrefetchedPics[i];
+
+        if (pic->state == PREFETCH_READY && pic->gfx != NULL
+         && pic->species == species && pic->personality == personality)
+        {
+            CpuCopy32(pic->gfx, dest, GetDecompressedDataSize(gMonFrontPicTable[species].data));
+            FREE_AND_SET_NULL(pic->gfx);
+            TryClearPrefetchedPic(pic);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+bool8 TryLoadPrefetchedBattlePalette(const u32 *lzPaletteData, void *dest)
+{
+    u32 i;
+
+    for (i = 0; i < NUM_PREFETCHED_PICS; i++)
+    {
+        struct PrefetchedBattlePic *pic = &sPrefetchedPics[i];
+
+        if (pic->state == PREFETCH_READY && pic->palette != NULL && pic->lzPalette == lzPaletteData)
+        {
+            CpuCopy16(pic->palette, dest, GetDecompressedDataSize(lzPaletteData));
+            FREE_AND_SET_NULL(pic->palette);
+            TryClearPrefetchedPic(pic);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void FreeBattlePicPrefetch(void)
+{
+    u32 i;
+    u8 taskId = FindTaskIdByFunc(Task_PrefetchBattlePics);
+
+    if (taskId != TASK_NONE)
+        DestroyTask(taskId);
+
+    for (i = 0; i < NUM_PREFETCHED_PICS; i++)
+    {
+        TRY_FREE_AND_SET_NULL(sPrefetchedPics[i].gfx);
+        TRY_FREE_AND_SET_NULL(sPrefetchedPics[i].palette);
+        sPrefetchedPics[i].state = PREFETCH_EMPTY;
+    }
+}
+
+#endif // BATTLE_PIC_PREFETCH
@@ -1,5 +1,6 @@
 #include "global.h"
 #include "battle.h"
+#include "battle_pic_prefetch.h"
 #include "battle_setup.h"
 #include "battle_transition.h"
 #include "main.h"
@@ -380,6 +381,11 @@ static void CreateBattleStartTask(u8 transition, u16 song)
 
     gTasks[taskId].tTransition = transition;
     PlayMapChosenOrBattleBGM(song);
+#ifdef BATTLE_PIC_PREFETCH
+    // Trainer parties are only created once the battle itself starts
+    if (!(gBattleTypeFlags & BATTLE_TYPE_TRAINER))
+        PrefetchOpponentBattlePics();
+#endif
 }
 
 #undef tState
@@ -2,6 +2,7 @@
 #include "battle.h"
 #include "battle_anim.h"
 #include "battle_controllers.h"
+#include "battle_pic_prefetch.h"
 #include "malloc.h"
 #include "pokemon.h"
 #include "trainer_hill.h"
@@ -69,6 +70,10 @@ void FreeBattleResources(void)
         FREE_AND_SET_NULL(gBattleAnimBgTileBuffer);
         FREE_AND_SET_NULL(gBattleAnimBgTilemapBuffer);
     }
+
+#ifdef BATTLE_PIC_PREFETCH
+    FreeBattlePicPrefetch();
+#endif
 }
 
 void AdjustFriendshipOnBattleFaint(u8 battlerId)
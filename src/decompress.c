@@ -268,6 +268,131 @@ u32 GetDecompressedDataSize(const u32 *ptr)
     return (ptr8[3] << 16) | (ptr8[2] << 8) | (ptr8[1]);
 }
 
+#if FAST_LZ
+
+// Decoder for the LZ4-style format written by gbagfx -lz4 (see tools/gbagfx/lz4.c).
+// It shares the LZ77 header layout, so GetDecompressedDataSize works on both.
+#define FAST_LZ_TYPE 0x40
+#define FAST_LZ_MIN_MATCH 4
+
+static const u8 *ReadFastLZLength(const u8 *src, u32 *length)
+{
+    u32 extra;
+
+    if (*length == 15)
+    {
+        do
+        {
+            extra = *src++;
+            *length += extra;
+        } while (extra == 255);
+    }
+    return src;
+}
+
+static void FastLZUnCompToWram(const u32 *src, u8 *dest)
+{
+    const u8 *src8 = (const u8 *)src + 4;
+    u8 *end = dest + GetDecompressedDataSize(src);
+    u32 token, length, distance;
+
+    while (dest < end)
+    {
+        token = *src8++;
+        length = token >> 4;
+        src8 = ReadFastLZLength(src8, &length);
+        memcpy(dest, src8, length);
+        dest += length;
+        src8 += length;
+
+        if (dest >= end)
+            break;
+
+        distance = src8[0] | (src8[1] << 8);
+        src8 += 2;
+        length = token & 0xF;
+        src8 = ReadFastLZLength(src8, &length);
+        length += FAST_LZ_MIN_MATCH;
+        if (distance >= length)
+        {
+            memcpy(dest, dest - distance, length);
+            dest += length;
+        }
+        else
+        {
+            while (length--)
+            {
+                *dest = *(dest - distance);
+                dest++;
+            }
+        }
+    }
+}
+
+// VRAM only accepts 16-bit writes, so bytes are paired up before being stored.
+// gbagfx never emits a match distance of 1, so a match can't read the unwritten byte.
+static void FastLZUnCompToVram(const u32 *src, u8 *dest)
+{
+    const u8 *src8 = (const u8 *)src + 4;
+    u32 size = GetDecompressedDataSize(src);
+    u32 destPos = 0;
+    u32 pending = 0;
+    u32 token, length, distance, value;
+
+    #define PUT_BYTE(byte)                                        \
+    {                                                             \
+        value = (byte);                                           \
+        if (destPos & 1)                                          \
+            *(vu16 *)&dest[destPos - 1] = pending | (value << 8); \
+        else                                                      \
+            pending = value;                                      \
+        destPos++;                                                \
+    }
+
+    while (destPos < size)
+    {
+        token = *src8++;
+        length = token >> 4;
+        src8 = ReadFastLZLength(src8, &length);
+        while (length--)
+            PUT_BYTE(*src8++);
+
+        if (destPos >= size)
+            break;
+
+        distance = src8[0] | (src8[1] << 8);
+        src8 += 2;
+        length = token & 0xF;
+        src8 = ReadFastLZLength(src8, &length);
+        length += FAST_LZ_MIN_MATCH;
+        while (length--)
+            PUT_BYTE(dest[destPos - distance]);
+    }
+
+    #undef PUT_BYTE
+
+    if (size & 1)
+        *(vu16 *)&dest[size - 1] = pending;
+}
+
+void FastLZUnCompWram(const u32 *src, void *dest)
+{
+    if (*(const u8 *)src == FAST_LZ_TYPE)
+        FastLZUnCompToWram(src, dest);
+    else
+        (LZ77UnCompWram)(src, dest);
+}
+
+void FastLZUnCompVram(const u32 *src, void *dest)
+{
+    if (*(const u8 *)src == FAST_LZ_TYPE)
+        FastLZUnCompToVram(src, dest);
+    else
+        (LZ77UnCompVram)(src, dest);
+}
+
+#endif // FAST_LZ
+
 bool8 LoadCompressedSpriteSheetUsingHeap(const struct CompressedSpriteSheet *src)
 {
     struct SpriteSheet dest;
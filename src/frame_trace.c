@@ -0,0 +1,126 @@
+#include "global.h"
+#include "frame_trace.h"
+
+// Records when each phase of a frame begins and ends into a ring buffer, and
+// prints the buffer in Chrome's trace event format through DebugPrintf when a
+// frame overruns its VBlank. Paste the printed lines into a .json file to load
+// it in a trace viewer (the closing bracket of the array is optional).
+//
+// Timestamps are taken from VCOUNT, so they have a resolution of one scanline
+// (1232 cycles, about 73 microseconds). Frames start at the beginning of VBlank.
+
+#ifdef FRAME_TRACE
+
+#define FRAME_TRACE_SIZE 1024 // must be a power of 2
+#define LINES_PER_FRAME 228
+
+#define TRACE_FLAG_BEGIN  (1 << 0)
+#define TRACE_FLAG_VBLANK (1 << 1) // recorded from the VBlank interrupt
+
+struct FrameTraceEvent
+{
+    u32 line; // scanlines since the first traced VBlank
+    u8 phase;
+    u8 flags;
+};
+
+static const char *const sPhaseNames[TRACE_PHASE_COUNT] =
+{
+    [TRACE_CALLBACKS]             = "CallCallbacks",
+    [TRACE_RUN_TASKS]             = "RunTasks",
+    [TRACE_ANIMATE_SPRITES]       = "AnimateSprites",
+    [TRACE_BUILD_OAM_BUFFER]      = "BuildOamBuffer",
+    [TRACE_RUN_TEXT_PRINTERS]     = "RunTextPrinters",
+    [TRACE_UPDATE_PALETTE_FADE]   = "UpdatePaletteFade",
+    [TRACE_VBLANK]                = "VBlankIntr",
+    [TRACE_PROCESS_DMA3_REQUESTS] = "ProcessDma3Requests",
+};
+
+static EWRAM_DATA struct FrameTraceEvent sFrameTraceEvents[FRAME_TRACE_SIZE] = {0};
+static EWRAM_DATA u32 sFrameTraceHead = 0;
+static EWRAM_DATA u32 sEventsSinceDump = 0;
+static EWRAM_DATA u32 sLastMainLoopFrame = 0;
+static vu32 sTraceFrame;
+static vbool8 sInVBlank;
+
+void RecordFrameTraceEvent(u8 phase, bool8 begin)
+{
+    struct FrameTraceEvent *event;
+    u32 frame, line;
+    u16 ime = REG_IME;
+
+    REG_IME = 0;
+
+    if (phase == TRACE_VBLANK && begin)
+    {
+        sTraceFrame++;
+        sInVBlank = TRUE;
+    }
+
+    line = REG_VCOUNT & 0xFF;
+    frame = sTraceFrame;
+
+    // VBlank has started, but its handler has not run yet
+    if (line >= DISPLAY_HEIGHT && (REG_IF & INTR_FLAG_VBLANK))
+        frame++;
+
+    event = &sFrameTraceEvents[sFrameTraceHead++ % FRAME_TRACE_SIZE];
+    event->line = frame * LINES_PER_FRAME + (line + LINES_PER_FRAME - DISPLAY_HEIGHT) % LINES_PER_FRAME;
+    event->phase = phase;
+    event->flags = (begin ? TRACE_FLAG_BEGIN : 0) | (sInVBlank ? TRACE_FLAG_VBLANK : 0);
+    sEventsSinceDump++;
+
+    if (phase == TRACE_VBLANK && !begin)
+        sInVBlank = FALSE;
+
+    REG_IME = ime;
+}
+
+// Called by the main loop once the frame's work is done. Dumps the trace if
+// the frame took longer than one VBlank and the buffer has refilled since the
+// last dump.
+void FrameTraceEndFrame(void)
+{
+    u32 frame = sTraceFrame;
+
+    if (frame - sLastMainLoopFrame > 1 && sEventsSinceDump >= FRAME_TRACE_SIZE)
+    {
+        DebugPrintf("frame trace: frame %d overran by %d VBlanks", frame, frame - sLastMainLoopFrame - 1);
+        DumpFrameTrace();
+        frame = sTraceFrame;
+    }
+    sLastMainLoopFrame = frame;
+}
+
+void DumpFrameTrace(void)
+{
+    u32 i, count, start, firstLine;
+    const struct FrameTraceEvent *event;
+
+    count = min(sFrameTraceHead, FRAME_TRACE_SIZE);
+    start = sFrameTraceHead - count;
+    firstLine = sFrameTraceEvents[start % FRAME_TRACE_SIZE].line;
+
+    DebugPrintf("[");
+    DebugPrintf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Main loop\"}},");
+    DebugPrintf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"VBlank\"}},");
+
+    for (i = 0; i < count; i++)
+    {
+        u32 lines;
+
+        event = &sFrameTraceEvents[(start + i) % FRAME_TRACE_SIZE];
+        lines = event->line - firstLine;
+
+        // One scanline lasts 73.43 microseconds
+        DebugPrintf("{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%u,\"pid\":0,\"tid\":%d},",
+                    sPhaseNames[event->phase],
+                    (event->flags & TRACE_FLAG_BEGIN) ? "B" : "E",
+                    lines * 73 + lines * 43 / 100,
+                    (event->flags & TRACE_FLAG_VBLANK) ? 1 : 0);
+    }
+
+    sEventsSinceDump = 0;
+}
+
+#endif // FRAME_TRACE
@@ -0,0 +1,221 @@
+#include "global.h"
+#include "input_replay.h"
+#include "siirtc.h"
+
+// Records the key state of every frame, along with the RNG seed, RTC probe and
+// RTC reads that depend on the outside world, or feeds a previous recording back in so
+// that a playthrough can be re-run exactly. Replays are only exact on the same
+// build and starting from the same save.
+//
+// The log is a stream of little-endian halfwords:
+//
+//   0kkk kkkk kkkk nnnn... a key run: the keys in bits 0-9 were held for
+//                          bits 10-14 plus one frames
+//   1000 tttt 0000 0000    an event of type t, followed by its 32-bit value
+//                          as two halfwords, low half first
+//
+// INPUT_EVENT_REPEAT extends the key run before it beyond 32 frames.
+//
+// Recordings are printed through DebugPrintf as lines of hex bytes prefixed
+// with "input: ". Joining them gives the binary log, for example with
+//   grep -o 'input: [0-9a-f]*' mgba.log | cut -c 8- | xxd -r -p > data/input_replay.bin
+// which INPUT_REPLAY builds include.
+
+#ifdef INPUT_LOGGING
+
+#define INPUT_EVENT_FLAG 0x8000
+#define KEY_RUN_SHIFT 10
+#define KEY_RUN_MAX 32
+
+#ifdef INPUT_RECORD
+
+// Completed key runs and events are written out at least this often, so that
+// stopping the emulator loses little of the recording. The run in progress is
+// left open so that holding the same keys, or none, still packs into one run.
+#define RECORD_FLUSH_FRAMES 600
+#define RECORD_BUFFER_SIZE 16
+
+static EWRAM_DATA u16 sRecordBuffer[RECORD_BUFFER_SIZE] = {0};
+static EWRAM_DATA u8 sRecordBufferCount = 0;
+static EWRAM_DATA u16 sRunKeys = 0;
+static EWRAM_DATA u32 sRunLength = 0;
+static EWRAM_DATA u16 sFramesSinceFlush = 0;
+
+static void FlushRecordBuffer(void)
+{
+    static const char sHexDigits[] = "0123456789abcdef";
+    char text[RECORD_BUFFER_SIZE * 4 + 1];
+    u32 i;
+
+    for (i = 0; i < sRecordBufferCount; i++)
+    {
+        text[i * 4 + 0] = sHexDigits[(sRecordBuffer[i] >> 4) & 0xF];
+        text[i * 4 + 1] = sHexDigits[sRecordBuffer[i] & 0xF];
+        text[i * 4 + 2] = sHexDigits[(sRecordBuffer[i] >> 12) & 0xF];
+        text[i * 4 + 3] = sHexDigits[(sRecordBuffer[i] >> 8) & 0xF];
+    }
+    text[i * 4] = '\0';
+
+    if (sRecordBufferCount != 0)
+        DebugPrintf("input: %s", text);
+    sRecordBufferCount = 0;
+}
+
+static void WriteRecordWord(u16 word)
+{
+    sRecordBuffer[sRecordBufferCount++] = word;
+    if (sRecordBufferCount >= RECORD_BUFFER_SIZE)
+        FlushRecordBuffer();
+}
+
+static void WriteEvent(u8 type, u32 value)
+{
+    WriteRecordWord(INPUT_EVENT_FLAG | (type << 8));
+    WriteRecordWord(value);
+    WriteRecordWord(value >> 16);
+}
+
+static void WriteKeyRun(void)
+{
+    if (sRunLength == 0)
+        return;
+
+    WriteRecordWord(sRunKeys | ((min(sRunLength, KEY_RUN_MAX) - 1) << KEY_RUN_SHIFT));
+    if (sRunLength > KEY_RUN_MAX)
+        WriteEvent(INPUT_EVENT_REPEAT, sRunLength - KEY_RUN_MAX);
+    sRunLength = 0;
+}
+
+u16 RecordOrReplayKeys(u16 keys)
+{
+    if (sRunLength != 0 && keys != sRunKeys)
+        WriteKeyRun();
+
+    sRunKeys = keys;
+    sRunLength++;
+
+    if (++sFramesSinceFlush >= RECORD_FLUSH_FRAMES)
+    {
+        FlushRecordBuffer();
+        sFramesSinceFlush = 0;
+    }
+
+    return keys;
+}
+
+u32 RecordOrReplayEvent(u8 type, u32 value)
+{
+    // Events belong after the frames that led up to them
+    WriteKeyRun();
+    WriteEvent(type, value);
+    return value;
+}
+
+void FlushInputRecording(void)
+{
+    WriteKeyRun();
+    FlushRecordBuffer();
+    sFramesSinceFlush = 0;
+}
+
+#else
+
+static const u16 sInputReplay[] = INCBIN_U16("data/input_replay.bin");
+
+static EWRAM_DATA u32 sReplayPos = 0;
+static EWRAM_DATA u32 sReplayFrame = 0;
+static EWRAM_DATA u32 sRunFramesLeft = 0;
+static EWRAM_DATA u16 sRunKeys = 0;
+static EWRAM_DATA bool8 sReplayStopped = FALSE;
+
+static void StopReplay(const char *reason)
+{
+    if (!sReplayStopped)
+        DebugPrintf("input replay %s at frame %d", reason, sReplayFrame);
+    sReplayStopped = TRUE;
+}
+
+static u32 ReadEventValue(void)
+{
+    u32 value = sInputReplay[sReplayPos + 1] | (sInputReplay[sReplayPos + 2] << 16);
+    sReplayPos += 3;
+    return value;
+}
+
+static bool8 ReadKeyRun(void)
+{
+    u16 word;
+
+    if (sReplayPos >= ARRAY_COUNT(sInputReplay))
+    {
+        StopReplay("finished");
+        return FALSE;
+    }
+
+    word = sInputReplay[sReplayPos];
+    if (word == (INPUT_EVENT_FLAG | (INPUT_EVENT_REPEAT << 8)) && sReplayPos + 2 < ARRAY_COUNT(sInputReplay))
+    {
+        sRunFramesLeft = ReadEventValue();
+    }
+    else if (!(word & INPUT_EVENT_FLAG))
+    {
+        sRunKeys = word & KEYS_MASK;
+        sRunFramesLeft = (word >> KEY_RUN_SHIFT) + 1;
+        sReplayPos++;
+    }
+    else
+    {
+        StopReplay("desynced");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+u16 RecordOrReplayKeys(u16 keys)
+{
+    if (sReplayStopped)
+        return keys;
+    if (sRunFramesLeft == 0 && !ReadKeyRun())
+        return keys;
+
+    sRunFramesLeft--;
+    sReplayFrame++;
+    return sRunKeys;
+}
+
+u32 RecordOrReplayEvent(u8 type, u32 value)
+{
+    if (sReplayStopped)
+        return value;
+
+    if (sRunFramesLeft != 0
+     || sReplayPos + 2 >= ARRAY_COUNT(sInputReplay)
+     || sInputReplay[sReplayPos] != (INPUT_EVENT_FLAG | (type << 8)))
+    {
+        StopReplay("desynced");
+        return value;
+    }
+    return ReadEventValue();
+}
+
+#endif // INPUT_RECORD
+
+void RecordOrReplayRtc(struct SiiRtcInfo *rtc)
+{
+    u32 date = rtc->year | (rtc->month << 8) | (rtc->day << 16) | (rtc->dayOfWeek << 24);
+    u32 time = rtc->hour | (rtc->minute << 8) | (rtc->second << 16) | (rtc->status << 24);
+
+    date = RecordOrReplayEvent(INPUT_EVENT_RTC_DATE, date);
+    time = RecordOrReplayEvent(INPUT_EVENT_RTC_TIME, time);
+
+    rtc->year = date;
+    rtc->month = date >> 8;
+    rtc->day = date >> 16;
+    rtc->dayOfWeek = date >> 24;
+    rtc->hour = time;
+    rtc->minute = time >> 8;
+    rtc->second = time >> 16;
+    rtc->status = time >> 24;
+}
+
+#endif // INPUT_LOGGING
@@ -20,6 +20,26 @@ struct MusicPlayerInfo gMPlayInfo_SE2;
 struct MusicPlayerInfo gMPlayInfo_SE3;
 u8 gMPlayMemAccArea[0x10];
 
+#ifdef M4A_KEY_FREQ_TABLE
+// Same result as below, with the scale lookups done at build time and the
+// interpolation skipped for notes without a fine adjustment.
+u32 MidiKeyToFreq(struct WaveData *wav, u8 key, u8 fineAdjust)
+{
+    u32 freq;
+
+    if (key > 178)
+    {
+        key = 178;
+        fineAdjust = 255;
+    }
+
+    freq = gKeyFreqTable[key];
+    if (fineAdjust != 0)
+        freq += umul3232H32(gKeyFreqTable[key + 1] - freq, fineAdjust << 24);
+
+    return umul3232H32(wav->freq, freq);
+}
+#else
 u32 MidiKeyToFreq(struct WaveData *wav, u8 key, u8 fineAdjust)
 {
     u32 val1;
@@ -40,6 +60,7 @@ u32 MidiKeyToFreq(struct WaveData *wav, u8 key, u8 fineAdjust)
 
     return umul3232H32(wav->freq, val1 + umul3232H32(val2 - val1, fineAdjustShifted));
 }
+#endif
 
 void UnusedDummyFunc(void)
 {
@@ -99,8 +120,115 @@ void m4aSoundInit(void)
     }
 }
 
+#ifdef M4A_VOICE_BUDGET
+EWRAM_DATA struct M4AVoiceStats gM4AVoiceStats = {0};
+
+// Installed as the sequencer's note-on handler. A held voice is stolen when
+// ply_note restarts a channel that was still sounding. Channels whose sample
+// already ran out have no status flags left, so reusing them is not counted.
+static void PlyNoteCountingSteals(u32 noteCmd, struct MusicPlayerInfo *mplayInfo, struct MusicPlayerTrack *track)
+{
+    u8 prevFlags[MAX_DIRECTSOUND_CHANNELS];
+    u32 i;
+
+    for (i = 0; i < gSoundInfo.maxChans; i++)
+        prevFlags[i] = gSoundInfo.chans[i].statusFlags;
+
+    ply_note(noteCmd, mplayInfo, track);
+
+    for (i = 0; i < gSoundInfo.maxChans; i++)
+    {
+        if ((prevFlags[i] & SOUND_CHANNEL_SF_ON)
+         && !(prevFlags[i] & (SOUND_CHANNEL_SF_START | SOUND_CHANNEL_SF_STOP))
+         && (gSoundInfo.chans[i].statusFlags & SOUND_CHANNEL_SF_START))
+            gM4AVoiceStats.stolenVoices++;
+    }
+}
+
+// The louder side of a releasing channel after the mixer's next release step.
+static u32 GetNextReleaseVolume(struct SoundChannel *chan)
+{
+    u32 envelope = (chan->envelopeVolume * chan->release) >> 8;
+
+    if (envelope < chan->pseudoEchoVolume)
+        envelope = chan->pseudoEchoVolume;
+    envelope = (envelope * (gSoundInfo.masterVolume + 1)) >> 4;
+
+    if (chan->rightVolume > chan->leftVolume)
+        return (chan->rightVolume * envelope) >> 8;
+    else
+        return (chan->leftVolume * envelope) >> 8;
+}
+
+static bool32 IsChanReleasing(struct SoundChannel *chan)
+{
+    return (chan->statusFlags & (SOUND_CHANNEL_SF_START | SOUND_CHANNEL_SF_STOP | SOUND_CHANNEL_SF_IEC)) == SOUND_CHANNEL_SF_STOP;
+}
+
+// Runs before the sequencer and mixer. Stops releasing voices that the mixer
+// would only keep mixing at zero volume, then the quietest releasing voices
+// while more than M4A_VOICE_BUDGET are active. Held notes are never cut.
+static void UpdateVoiceBudget(void)
+{
+    struct SoundChannel *chan;
+    u32 i, active = 0;
+
+    if (gSoundInfo.ident != ID_NUMBER)
+        return;
+
+    for (i = 0; i < gSoundInfo.maxChans; i++)
+    {
+        chan = &gSoundInfo.chans[i];
+
+        if (!(chan->statusFlags & SOUND_CHANNEL_SF_ON))
+            continue;
+
+        if (IsChanReleasing(chan) && GetNextReleaseVolume(chan) == 0)
+        {
+            chan->statusFlags = 0;
+            gM4AVoiceStats.retiredVoices++;
+        }
+        else
+        {
+            active++;
+        }
+    }
+
+    while (active > M4A_VOICE_BUDGET)
+    {
+        struct SoundChannel *quietest = NULL;
+        u32 quietestVolume = 0xFFFFFFFF;
+
+        for (i = 0; i < gSoundInfo.maxChans; i++)
+        {
+            chan = &gSoundInfo.chans[i];
+            if (IsChanReleasing(chan) && GetNextReleaseVolume(chan) < quietestVolume)
+            {
+                quietest = chan;
+                quietestVolume = GetNextReleaseVolume(chan);
+            }
+        }
+
+        if (quietest == NULL)
+            break;
+
+        quietest->statusFlags = 0;
+        gM4AVoiceStats.retiredVoices++;
+        active--;
+    }
+
+    gM4AVoiceStats.activeVoices = active;
+    if (active > gM4AVoiceStats.maxActiveVoices)
+        gM4AVoiceStats.maxActiveVoices = active;
+    gM4AVoiceStats.mixedVoiceFrames += active;
+}
+#endif // M4A_VOICE_BUDGET
+
 void m4aSoundMain(void)
 {
+#ifdef M4A_VOICE_BUDGET
+    UpdateVoiceBudget();
+#endif
     SoundMain();
 }
 
@@ -362,7 +490,11 @@ void SoundInit(struct SoundInfo *soundInfo)
 
     soundInfo->maxChans = 8;
     soundInfo->masterVolume = 15;
+#ifdef M4A_VOICE_BUDGET
+    soundInfo->plynote = PlyNoteCountingSteals;
+#else
     soundInfo->plynote = ply_note;
+#endif
     soundInfo->CgbSound = DummyFunc;
     soundInfo->CgbOscOff = (CgbOscOffFunc)DummyFunc;
     soundInfo->MidiKeyToCgbFreq = (MidiKeyToCgbFreqFunc)DummyFunc;
@@ -99,6 +99,43 @@ const u32 gFreqTable[] =
     4053909305u,
 };
 
+#ifdef M4A_KEY_FREQ_TABLE
+// gFreqTable[gScaleTable[key] & 0xF] >> (gScaleTable[key] >> 4) for every key
+const u32 gKeyFreqTable[] =
+{
+    131072u, 138865u, 147123u, 155871u, 165140u, 174960u,
+    185363u, 196386u, 208063u, 220435u, 233543u, 247430u,
+    262144u, 277731u, 294246u, 311743u, 330280u, 349920u,
+    370727u, 392772u, 416127u, 440871u, 467087u, 494861u,
+    524288u, 555463u, 588493u, 623487u, 660561u, 699840u,
+    741455u, 785544u, 832255u, 881743u, 934175u, 989723u,
+    1048576u, 1110927u, 1176986u, 1246974u, 1321122u, 1399681u,
+    1482910u, 1571088u, 1664510u, 1763487u, 1868350u, 1979447u,
+    2097152u, 2221855u, 2353973u, 2493948u, 2642245u, 2799362u,
+    2965820u, 3142177u, 3329021u, 3526975u, 3736700u, 3958895u,
+    4194304u, 4443710u, 4707947u, 4987896u, 5284491u, 5598724u,
+    5931641u, 6284355u, 6658042u, 7053950u, 7473400u, 7917791u,
+    8388608u, 8887420u, 9415894u, 9975792u, 10568983u, 11197448u,
+    11863283u, 12568710u, 13316085u, 14107900u, 14946800u, 15835583u,
+    16777216u, 17774841u, 18831788u, 19951584u, 21137967u, 22394896u,
+    23726566u, 25137421u, 26632170u, 28215801u, 29893600u, 31671166u,
+    33554432u, 35549682u, 37663576u, 39903169u, 42275935u, 44789793u,
+    47453132u, 50274842u, 53264340u, 56431603u, 59787200u, 63342332u,
+    67108864u, 71099364u, 75327152u, 79806338u, 84551870u, 89579586u,
+    94906265u, 100549685u, 106528681u, 112863206u, 119574401u, 126684665u,
+    134217728u, 142198729u, 150654305u, 159612677u, 169103740u, 179159172u,
+    189812531u, 201099371u, 213057362u, 225726412u, 239148803u, 253369331u,
+    268435456u, 284397458u, 301308611u, 319225354u, 338207481u, 358318345u,
+    379625062u, 402198743u, 426114725u, 451452825u, 478297607u, 506738663u,
+    536870912u, 568794917u, 602617223u, 638450708u, 676414963u, 716636690u,
+    759250125u, 804397486u, 852229450u, 902905650u, 956595214u, 1013477326u,
+    1073741824u, 1137589835u, 1205234447u, 1276901417u, 1352829926u, 1433273380u,
+    1518500250u, 1608794973u, 1704458901u, 1805811301u, 1913190429u, 2026954652u,
+    2147483648u, 2275179671u, 2410468894u, 2553802834u, 2705659852u, 2866546760u,
+    3037000500u, 3217589947u, 3408917802u, 3611622603u, 3826380858u, 4053909305u,
+};
+#endif
+
 const u16 gPcmSamplesPerVBlankTable[] =
 {
     96,
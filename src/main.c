@@ -12,6 +12,8 @@
 #include "play_time.h"
 #include "random.h"
 #include "dma3.h"
+#include "frame_trace.h"
+#include "input_replay.h"
 #include "gba/flash_internal.h"
 #include "load_save.h"
 #include "gpu_regs.h"
@@ -30,6 +32,10 @@ static void HBlankIntr(void);
 static void VCountIntr(void);
 static void SerialIntr(void);
 static void IntrDummy(void);
+#if HEADLESS
+static void HeadlessVBlankIntr(void);
+static void ReportHeadlessFrameRate(void);
+#endif
 
 const u8 gGameVersion = GAME_VERSION;
 
@@ -71,6 +77,14 @@ s8 gPcmDmaCounter;
 
 static EWRAM_DATA u16 sTrainerId = 0;
 
+#if HEADLESS
+// Frames run by the main loop and frames actually shown by the LCD, since the
+// last frame rate report
+static u32 sHeadlessFrames;
+static vu32 sHeadlessDisplayFrames;
+static u32 sHeadlessTotalFrames;
+#endif
+
 //EWRAM_DATA void (**gFlashTimerIntrFunc)(void) = NULL;
 
 static void UpdateLinkAndCallCallbacks(void);
@@ -164,6 +178,9 @@ void AgbMain()
 
         PlayTimeCounter_Update();
         MapMusicMain();
+#ifdef FRAME_TRACE
+        FrameTraceEndFrame();
+#endif
         WaitForVBlank();
     }
 }
@@ -187,11 +204,13 @@ static void InitMainCallbacks(void)
 
 static void CallCallbacks(void)
 {
+    TRACE_BEGIN(TRACE_CALLBACKS);
     if (gMain.callback1)
         gMain.callback1();
 
     if (gMain.callback2)
         gMain.callback2();
+    TRACE_END(TRACE_CALLBACKS);
 }
 
 void SetMainCallback2(MainCallback callback)
@@ -208,6 +227,9 @@ void StartTimer1(void)
 void SeedRngAndSetTrainerId(void)
 {
     u16 val = REG_TM1CNT_L;
+#ifdef INPUT_LOGGING
+    val = RecordOrReplayEvent(INPUT_EVENT_RNG_SEED, val);
+#endif
     SeedRng(val);
     REG_TM1CNT_H = 0;
     sTrainerId = val;
@@ -250,6 +272,9 @@ void InitKeys(void)
 static void ReadKeys(void)
 {
     u16 keyInput = REG_KEYINPUT ^ KEYS_MASK;
+#ifdef INPUT_LOGGING
+    keyInput = RecordOrReplayKeys(keyInput);
+#endif
     gMain.newKeysRaw = keyInput & ~gMain.heldKeysRaw;
     gMain.newKeys = gMain.newKeysRaw;
     gMain.newAndRepeatedKeys = gMain.newKeysRaw;
@@ -298,6 +323,11 @@ void InitIntrHandlers(void)
     for (i = 0; i < INTR_COUNT; i++)
         gIntrTable[i] = gIntrTableTemplate[i];
 
+#if HEADLESS
+    // The VBlank work is run by WaitForVBlank instead
+    gIntrTable[4] = HeadlessVBlankIntr;
+#endif
+
     DmaCopy32(3, IntrMain, IntrMain_Buffer, sizeof(IntrMain_Buffer));
 
     INTR_VECTOR = IntrMain_Buffer;
@@ -339,6 +369,7 @@ void SetSerialCallback(IntrCallback callback)
 
 static void VBlankIntr(void)
 {
+    TRACE_BEGIN(TRACE_VBLANK);
     if (gWirelessCommType != 0)
         RfuVSync();
     else if (gLinkVSyncDisabled == FALSE)
@@ -355,7 +386,9 @@ static void VBlankIntr(void)
     gMain.vblankCounter2++;
 
     CopyBufferedValuesToGpuRegs();
+    TRACE_BEGIN(TRACE_PROCESS_DMA3_REQUESTS);
     ProcessDma3Requests();
+    TRACE_END(TRACE_PROCESS_DMA3_REQUESTS);
 
     gPcmDmaCounter = gSoundInfo.pcmDmaCounter;
 
@@ -369,6 +402,7 @@ static void VBlankIntr(void)
 
     INTR_CHECK |= INTR_FLAG_VBLANK;
     gMain.intrCheck |= INTR_FLAG_VBLANK;
+    TRACE_END(TRACE_VBLANK);
 }
 
 void InitFlashTimer(void)
@@ -407,6 +441,46 @@ static void SerialIntr(void)
 static void IntrDummy(void)
 {}
 
+#if HEADLESS
+// Only keeps VBlankIntrWait working and counts displayed frames for the report.
+static void HeadlessVBlankIntr(void)
+{
+    sHeadlessDisplayFrames++;
+    INTR_CHECK |= INTR_FLAG_VBLANK;
+}
+
+static void ReportHeadlessFrameRate(void)
+{
+    u32 displayFrames = sHeadlessDisplayFrames;
+
+    sHeadlessDisplayFrames = 0;
+    if (displayFrames == 0)
+        displayFrames = 1;
+
+    // The LCD refreshes at 59.73 Hz
+    DebugPrintf("headless: %d frames, %d fps, %d%% speed",
+                sHeadlessTotalFrames,
+                sHeadlessFrames * 5973 / (displayFrames * 100),
+                sHeadlessFrames * 100 / displayFrames);
+    sHeadlessFrames = 0;
+}
+
+// Runs the VBlank work as soon as the frame's callbacks are done, so the game
+// runs as fast as the CPU allows. Frames that are not meant to be seen are
+// hidden with forced blank.
+static void WaitForVBlank(void)
+{
+    VBlankIntr();
+
+    sHeadlessFrames++;
+    sHeadlessTotalFrames++;
+
+    HideHeadlessFrame(HEADLESS_RENDER_INTERVAL == 0 || sHeadlessTotalFrames % HEADLESS_RENDER_INTERVAL != 0);
+
+    if (sHeadlessFrames >= HEADLESS_REPORT_INTERVAL)
+        ReportHeadlessFrameRate();
+}
+#else
 static void WaitForVBlank(void)
 {
     gMain.intrCheck &= ~INTR_FLAG_VBLANK;
@@ -414,6 +488,7 @@ static void WaitForVBlank(void)
     while (!(gMain.intrCheck & INTR_FLAG_VBLANK))
         ;
 }
+#endif
 
 void SetTrainerHillVBlankCounter(u32 *counter)
 {
@@ -427,6 +502,12 @@ void ClearTrainerHillVBlankCounter(void)
 
 void DoSoftReset(void)
 {
+#if HEADLESS
+    ReportHeadlessFrameRate();
+#endif
+#ifdef INPUT_RECORD
+    FlushInputRecording();
+#endif
     REG_IME = 0;
     m4aSoundVSyncOff();
     ScanlineEffect_Stop();
@@ -2,6 +2,7 @@
 #include "palette.h"
 #include "util.h"
 #include "decompress.h"
+#include "frame_trace.h"
 #include "gpu_regs.h"
 #include "task.h"
 #include "constants/rgb.h"
@@ -121,6 +122,7 @@ u8 UpdatePaletteFade(void)
     if (sPlttBufferTransferPending)
         return PALETTE_FADE_STATUS_LOADING;
 
+    TRACE_BEGIN(TRACE_UPDATE_PALETTE_FADE);
     if (gPaletteFade.mode == NORMAL_FADE)
         result = UpdateNormalPaletteFade();
     else if (gPaletteFade.mode == FAST_FADE)
@@ -129,6 +131,7 @@ u8 UpdatePaletteFade(void)
         result = UpdateHardwarePaletteFade();
 
     sPlttBufferTransferPending = gPaletteFade.multipurpose1 | dummy;
+    TRACE_END(TRACE_UPDATE_PALETTE_FADE);
 
     return result;
 }
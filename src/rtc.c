@@ -1,5 +1,6 @@
 #include "global.h"
 #include "rtc.h"
+#include "input_replay.h"
 #include "string_util.h"
 #include "text.h"
 
@@ -103,6 +104,11 @@ void RtcInit(void)
     sProbeResult = SiiRtcProbe();
     RtcRestoreInterrupts();
 
+#ifdef INPUT_LOGGING
+    // Whether a clock was found decides which RTC reads follow
+    sProbeResult = RecordOrReplayEvent(INPUT_EVENT_RTC_PROBE, sProbeResult);
+#endif
+
     if ((sProbeResult & 0xF) != 1)
     {
         sErrorStatus = RTC_INIT_ERROR;
@@ -149,6 +155,9 @@ void RtcGetRawInfo(struct SiiRtcInfo *rtc)
 {
     RtcGetStatus(rtc);
     RtcGetDateTime(rtc);
+#ifdef INPUT_LOGGING
+    RecordOrReplayRtc(rtc);
+#endif
 }
 
 u16 RtcCheckInfo(struct SiiRtcInfo *rtc)
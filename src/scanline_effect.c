@@ -18,10 +18,37 @@ EWRAM_DATA u16 ALIGNED(4) gScanlineEffectRegBuffers[2][0x3C0] = {0};
 EWRAM_DATA struct ScanlineEffect gScanlineEffect = {0};
 EWRAM_DATA static bool8 sShouldStopWaveTask = FALSE;
 
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+EWRAM_DATA struct ScanlineEffectFrameTable gScanlineEffectFrameTable = {0};
+
+// Set when a renderer applies gScanlineEffectFrameTable itself, in which case
+// the HBlank DMA is not started
+EWRAM_DATA static bool8 sFrameTableHasConsumer = FALSE;
+
+void ScanlineEffect_SetFrameTableConsumer(bool8 hasConsumer)
+{
+    sFrameTableHasConsumer = hasConsumer;
+}
+
+static void PublishFrameTable(void)
+{
+    gScanlineEffectFrameTable.values = gScanlineEffectRegBuffers[gScanlineEffect.srcBuffer];
+    gScanlineEffectFrameTable.regOffset = (u32)gScanlineEffect.dmaDest - REG_BASE;
+    if (gScanlineEffect.setFirstScanlineReg == CopyValue16Bit)
+        gScanlineEffectFrameTable.valueSize = sizeof(u16);
+    else
+        gScanlineEffectFrameTable.valueSize = sizeof(u32);
+    gScanlineEffectFrameTable.active = TRUE;
+}
+#endif
+
 void ScanlineEffect_Stop(void)
 {
     gScanlineEffect.state = 0;
     DmaStop(0);
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+    gScanlineEffectFrameTable.active = FALSE;
+#endif
     if (gScanlineEffect.waveTaskId != TASK_NONE)
     {
         DestroyTask(gScanlineEffect.waveTaskId);
@@ -71,6 +98,10 @@ void ScanlineEffect_SetParams(struct ScanlineEffectParams params)
 
 void ScanlineEffect_InitHBlankDmaTransfer(void)
 {
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+    gScanlineEffectFrameTable.active = FALSE;
+#endif
+
     if (gScanlineEffect.state == 0)
     {
         return;
@@ -81,8 +112,19 @@ void ScanlineEffect_InitHBlankDmaTransfer(void)
         DmaStop(0);
         sShouldStopWaveTask = TRUE;
     }
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+    else if (sFrameTableHasConsumer)
+    {
+        DmaStop(0);
+        PublishFrameTable();
+        gScanlineEffect.srcBuffer ^= 1;
+    }
+#endif
     else
     {
+#ifdef SCANLINE_EFFECT_FRAME_TABLE
+        PublishFrameTable();
+#endif
         DmaStop(0);
         // Set DMA to copy to dest register on each HBlank for the next frame.
         // The HBlank DMA transfers do not occurr during VBlank, so the transfer
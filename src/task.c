@@ -1,5 +1,6 @@
 #include "global.h"
 #include "task.h"
+#include "frame_trace.h"
 
 struct Task gTasks[NUM_TASKS];
 
@@ -111,6 +112,8 @@ void RunTasks(void)
 {
     u8 taskId = FindFirstActiveTask();
 
+    TRACE_BEGIN(TRACE_RUN_TASKS);
+
     if (taskId != NUM_TASKS)
     {
         do
@@ -119,6 +122,7 @@ void RunTasks(void)
             taskId = gTasks[taskId].next;
         } while (taskId != TAIL_SENTINEL);
     }
+    TRACE_END(TRACE_RUN_TASKS);
 }
 
 static u8 FindFirstActiveTask(void)
@@ -24,6 +24,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <limits.h>
+#include <pthread.h>
 
 /* extended.c */
 void ieee754_write_extended (double, uint8_t*);
@@ -878,55 +879,163 @@ void pcm2aif(const char *pcm_filename, const char *aif_filename, uint32_t base_n
 	free(aif);
 }
 
-void usage(void)
+// Like read_bytearray, but returns NULL instead of failing if the file can't be read.
+struct Bytes *try_read_bytearray(const char *filename)
 {
-	fprintf(stderr, "Usage: aif2pcm bin_file [aif_file]\n");
-	fprintf(stderr, "       aif2pcm aif_file [bin_file] [--compress]\n");
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+	{
+		return NULL;
+	}
+	struct Bytes *bytes = malloc(sizeof(struct Bytes));
+	fseek(f, 0, SEEK_END);
+	bytes->length = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	bytes->data = malloc(bytes->length + 1);
+	unsigned long read = fread(bytes->data, 1, bytes->length, f);
+	fclose(f);
+	if (read != bytes->length)
+	{
+		free_bytearray(bytes);
+		return NULL;
+	}
+	return bytes;
 }
 
-int main(int argc, char **argv)
+// 64-bit FNV-1a
+uint64_t hash_bytes(uint64_t hash, const uint8_t *data, unsigned long length)
 {
-	if (argc < 2)
+	for (unsigned long i = 0; i < length; i++)
 	{
-		usage();
-		exit(1);
+		hash ^= data[i];
+		hash *= 0x100000001B3;
 	}
+	return hash;
+}
 
-	char *input_file = argv[1];
-	char *extension = get_file_extension(input_file);
-	char *output_file;
-	bool compressed = false;
+static const char *cache_dir;
+static uint64_t program_hash;
 
-	if (argc > 3)
+// Enables the cache if TOOLS_CACHE_DIR is set. Every key starts with a hash of the
+// aif2pcm executable, so that entries written by a different build of aif2pcm are
+// never reused. If the executable can't be read from program_filename, the cache
+// stays disabled.
+void init_cache(const char *program_filename)
+{
+	const char *dir = getenv("TOOLS_CACHE_DIR");
+	if (!dir || dir[0] == '\0')
 	{
-		for (int i = 3; i < argc; i++)
+		return;
+	}
+
+	struct Bytes *program = try_read_bytearray(program_filename);
+	if (!program)
+	{
+		char *exe_filename = malloc(strlen(program_filename) + 5);
+		sprintf(exe_filename, "%s.exe", program_filename);
+		program = try_read_bytearray(exe_filename);
+		free(exe_filename);
+		if (!program)
 		{
-			if (strcmp(argv[i], "--compress") == 0)
-			{
-				compressed = true;
-			}
+			return;
 		}
 	}
 
+	program_hash = hash_bytes(0xCBF29CE484222325, program->data, program->length);
+	free_bytearray(program);
+	cache_dir = dir;
+}
+
+// Returns where the output for this input is cached, or NULL if the cache is disabled.
+char *get_cache_filename(const char *aif_filename, bool compress)
+{
+	if (!cache_dir)
+	{
+		return NULL;
+	}
+
+	struct Bytes *aif = read_bytearray(aif_filename);
+	const char *options = compress ? "--compress\n" : "\n";
+	uint64_t hash = hash_bytes(program_hash, (const uint8_t *)options, strlen(options));
+	hash = hash_bytes(hash, aif->data, aif->length);
+	free_bytearray(aif);
+
+	char *cache_filename = malloc(strlen(cache_dir) + 32);
+	sprintf(cache_filename, "%s/aif2pcm-%016llx.bin", cache_dir, (unsigned long long)hash);
+	return cache_filename;
+}
+
+// Like aif2pcm, but reuses the output from TOOLS_CACHE_DIR if the same input was converted before.
+void aif2pcm_cached(const char *aif_filename, const char *pcm_filename, bool compress)
+{
+	char *cache_filename = get_cache_filename(aif_filename, compress);
+	if (!cache_filename)
+	{
+		aif2pcm(aif_filename, pcm_filename, compress);
+		return;
+	}
+
+	struct Bytes *cached = try_read_bytearray(cache_filename);
+	if (cached)
+	{
+		write_bytearray(pcm_filename, cached);
+		free_bytearray(cached);
+		free(cache_filename);
+		return;
+	}
+
+	aif2pcm(aif_filename, pcm_filename, compress);
+
+	// Write to a temporary name first so that a concurrent build never picks up
+	// a partial file. The output name keeps the temporary names of concurrent
+	// writers apart.
+	struct Bytes *output = read_bytearray(pcm_filename);
+	uint64_t writer = hash_bytes(0xCBF29CE484222325, (const uint8_t *)pcm_filename, strlen(pcm_filename));
+	char *temp_filename = malloc(strlen(cache_filename) + 32);
+	sprintf(temp_filename, "%s.%016llx.tmp", cache_filename, (unsigned long long)writer);
+	FILE *f = fopen(temp_filename, "wb");
+	if (f)
+	{
+		bool written = fwrite(output->data, 1, output->length, f) == output->length;
+		if (fclose(f) == 0 && written)
+		{
+			rename(temp_filename, cache_filename);
+		}
+		else
+		{
+			remove(temp_filename);
+		}
+	}
+	free_bytearray(output);
+	free(temp_filename);
+	free(cache_filename);
+}
+
+void convert(char *input_file, char *output_file, bool compressed)
+{
+	char *extension = get_file_extension(input_file);
+	if (!extension)
+	{
+		FATAL_ERROR("Input file must be .aif or .bin: '%s'\n", input_file);
+	}
+
 	if (strcmp(extension, "aif") == 0 || strcmp(extension, "aiff") == 0)
 	{
-		if (argc >= 3)
+		if (output_file)
 		{
-			output_file = argv[2];
-			aif2pcm(input_file, output_file, compressed);
+			aif2pcm_cached(input_file, output_file, compressed);
 		}
 		else
 		{
 			output_file = new_file_extension(input_file, "bin");
-			aif2pcm(input_file, output_file, compressed);
+			aif2pcm_cached(input_file, output_file, compressed);
 			free(output_file);
 		}
 	}
 	else if (strcmp(extension, "bin") == 0)
 	{
-		if (argc >= 3)
+		if (output_file)
 		{
-			output_file = argv[2];
 			pcm2aif(input_file, output_file, 60);
 		}
 		else
@@ -940,6 +1049,175 @@ int main(int argc, char **argv)
 	{
 		FATAL_ERROR("Input file must be .aif or .bin: '%s'\n", input_file);
 	}
+}
+
+struct BatchJob {
+	char *input_file;
+	char *output_file;
+	bool compressed;
+};
+
+struct Batch {
+	struct BatchJob *jobs;
+	int num_jobs;
+	int next_job;
+	pthread_mutex_t lock;
+};
+
+void *batch_worker(void *arg)
+{
+	struct Batch *batch = arg;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&batch->lock);
+		int job = batch->next_job++;
+		pthread_mutex_unlock(&batch->lock);
+
+		if (job >= batch->num_jobs)
+		{
+			return NULL;
+		}
+		convert(batch->jobs[job].input_file, batch->jobs[job].output_file, batch->jobs[job].compressed);
+	}
+}
+
+// Converts every line of the manifest ("input [output] [--compress]") as if
+// it was passed on the command line, spread over a number of threads.
+void convert_batch(const char *manifest_filename, int num_threads)
+{
+	struct Bytes *manifest = try_read_bytearray(manifest_filename);
+	if (!manifest)
+	{
+		FATAL_ERROR("Failed to open '%s' for reading!\n", manifest_filename);
+	}
+	manifest->data[manifest->length] = '\0';
+
+	struct Batch batch = {0};
+	int capacity = 0;
+	char *line = (char *)manifest->data;
+
+	while (*line)
+	{
+		char *end = strchr(line, '\n');
+		if (end)
+		{
+			*end = '\0';
+		}
+
+		struct BatchJob job = {0};
+		char *word = strtok(line, " \t\r");
+		while (word)
+		{
+			if (strcmp(word, "--compress") == 0)
+				job.compressed = true;
+			else if (!job.input_file)
+				job.input_file = word;
+			else if (!job.output_file)
+				job.output_file = word;
+			word = strtok(NULL, " \t\r");
+		}
+
+		if (job.input_file)
+		{
+			if (batch.num_jobs == capacity)
+			{
+				capacity = capacity ? capacity * 2 : 64;
+				batch.jobs = realloc(batch.jobs, capacity * sizeof(struct BatchJob));
+			}
+			batch.jobs[batch.num_jobs++] = job;
+		}
+
+		if (!end)
+		{
+			break;
+		}
+		line = end + 1;
+	}
+
+	pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+	pthread_mutex_init(&batch.lock, NULL);
+	for (int i = 0; i < num_threads; i++)
+	{
+		if (pthread_create(&threads[i], NULL, batch_worker, &batch) != 0)
+		{
+			FATAL_ERROR("Failed to start worker thread!\n");
+		}
+	}
+	for (int i = 0; i < num_threads; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	pthread_mutex_destroy(&batch.lock);
+
+	free(threads);
+	free(batch.jobs);
+	free_bytearray(manifest);
+}
+
+void usage(void)
+{
+	fprintf(stderr, "Usage: aif2pcm bin_file [aif_file]\n");
+	fprintf(stderr, "       aif2pcm aif_file [bin_file] [--compress]\n");
+	fprintf(stderr, "       aif2pcm --batch manifest [-j threads]\n");
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		usage();
+		exit(1);
+	}
+
+	init_cache(argv[0]);
+
+	if (strcmp(argv[1], "--batch") == 0)
+	{
+		int num_threads = 1;
+
+		if (argc < 3)
+		{
+			usage();
+			exit(1);
+		}
+		for (int i = 3; i < argc; i++)
+		{
+			if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+				num_threads = atoi(argv[++i]);
+			else if (strncmp(argv[i], "-j", 2) == 0 && argv[i][2] != '\0')
+				num_threads = atoi(argv[i] + 2);
+			else
+			{
+				usage();
+				exit(1);
+			}
+		}
+
+		convert_batch(argv[2], num_threads > 0 ? num_threads : 1);
+		return 0;
+	}
+
+	char *output_file = NULL;
+	bool compressed = false;
+
+	if (argc > 3)
+	{
+		for (int i = 3; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--compress") == 0)
+			{
+				compressed = true;
+			}
+		}
+	}
+
+	if (argc >= 3)
+	{
+		output_file = argv[2];
+	}
+
+	convert(argv[1], output_file, compressed);
 
 	return 0;
 }
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "global.h"
+#include "batch.h"
+#include "util.h"
+
+// Runs every line of a manifest as if it was passed on the command line
+// ("INPUT_PATH OUTPUT_PATH [options...]"), spread over a pool of threads.
+// Lines are started in order, and a line whose input is the output of an
+// earlier line waits for it, so a manifest can be written in the order of
+// a dependency graph (e.g. .png to .4bpp, then .4bpp to .4bpp.lz).
+
+#define MAX_JOB_ARGS 32
+
+struct BatchJob
+{
+    int argc;
+    char *argv[MAX_JOB_ARGS];
+    int dependency;
+    bool done;
+};
+
+struct Batch
+{
+    struct BatchJob *jobs;
+    int jobCount;
+    int nextJob;
+    void (*convert)(int argc, char **argv);
+    pthread_mutex_t lock;
+    pthread_cond_t jobDone;
+};
+
+struct OutputIndex
+{
+    char *path;
+    int job;
+};
+
+static int CompareOutputIndices(const void *a, const void *b)
+{
+    const struct OutputIndex *indexA = a;
+    const struct OutputIndex *indexB = b;
+    int result = strcmp(indexA->path, indexB->path);
+
+    // Later jobs first, so a search finds the most recent writer.
+    return result != 0 ? result : indexB->job - indexA->job;
+}
+
+// Links every job to the last earlier job that writes its input.
+static void FindDependencies(struct Batch *batch)
+{
+    struct OutputIndex *outputs = malloc(sizeof(struct OutputIndex) * (batch->jobCount + 1));
+
+    if (outputs == NULL)
+        FATAL_ERROR("Failed to allocate memory for batch.\n");
+
+    for (int i = 0; i < batch->jobCount; i++)
+    {
+        outputs[i].path = batch->jobs[i].argv[2];
+        outputs[i].job = i;
+    }
+
+    qsort(outputs, batch->jobCount, sizeof(struct OutputIndex), CompareOutputIndices);
+
+    for (int i = 0; i < batch->jobCount; i++)
+    {
+        char *inputPath = batch->jobs[i].argv[1];
+        int low = 0;
+        int high = batch->jobCount;
+
+        // Find the first entry for this path, which is its latest writer.
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            int result = strcmp(outputs[mid].path, inputPath);
+
+            if (result < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        batch->jobs[i].dependency = -1;
+
+        // Skip writers that come after this job.
+        while (low < batch->jobCount && strcmp(outputs[low].path, inputPath) == 0)
+        {
+            if (outputs[low].job < i)
+            {
+                batch->jobs[i].dependency = outputs[low].job;
+                break;
+            }
+
+            low++;
+        }
+    }
+
+    free(outputs);
+}
+
+static void *BatchWorker(void *arg)
+{
+    struct Batch *batch = arg;
+
+    pthread_mutex_lock(&batch->lock);
+
+    while (batch->nextJob < batch->jobCount)
+    {
+        struct BatchJob *job = &batch->jobs[batch->nextJob++];
+
+        while (job->dependency >= 0 && !batch->jobs[job->dependency].done)
+            pthread_cond_wait(&batch->jobDone, &batch->lock);
+
+        pthread_mutex_unlock(&batch->lock);
+        batch->convert(job->argc, job->argv);
+        pthread_mutex_lock(&batch->lock);
+
+        job->done = true;
+        pthread_cond_broadcast(&batch->jobDone);
+    }
+
+    pthread_mutex_unlock(&batch->lock);
+    return NULL;
+}
+
+void ConvertBatch(char *manifestPath, int threadCount, void (*convert)(int argc, char **argv))
+{
+    int fileSize;
+    unsigned char *manifest = ReadWholeFileZeroPadded(manifestPath, &fileSize, 1);
+    struct Batch batch = { .convert = convert };
+    int jobCapacity = 0;
+    char *line = (char *)manifest;
+
+    while (*line != 0)
+    {
+        char *lineEnd = strchr(line, '\n');
+
+        if (lineEnd != NULL)
+            *lineEnd = 0;
+
+        struct BatchJob job = { .argc = 1, .argv = { "gbagfx" } };
+        char *word = line;
+
+        for (;;)
+        {
+            word += strspn(word, " \t\r");
+
+            if (*word == 0)
+                break;
+
+            if (job.argc == MAX_JOB_ARGS)
+                FATAL_ERROR("Too many arguments in manifest \"%s\".\n", manifestPath);
+
+            job.argv[job.argc++] = word;
+            word += strcspn(word, " \t\r");
+
+            if (*word != 0)
+                *word++ = 0;
+        }
+
+        if (job.argc == 2)
+            FATAL_ERROR("No output path in manifest \"%s\".\n", manifestPath);
+
+        if (job.argc > 2)
+        {
+            if (batch.jobCount == jobCapacity)
+            {
+                jobCapacity = jobCapacity != 0 ? jobCapacity * 2 : 256;
+                batch.jobs = realloc(batch.jobs, sizeof(struct BatchJob) * jobCapacity);
+
+                if (batch.jobs == NULL)
+                    FATAL_ERROR("Failed to allocate memory for batch.\n");
+            }
+
+            batch.jobs[batch.jobCount++] = job;
+        }
+
+        if (lineEnd == NULL)
+            break;
+
+        line = lineEnd + 1;
+    }
+
+    FindDependencies(&batch);
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * threadCount);
+
+    if (threads == NULL)
+        FATAL_ERROR("Failed to allocate memory for batch.\n");
+
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.jobDone, NULL);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        if (pthread_create(&threads[i], NULL, BatchWorker, &batch) != 0)
+            FATAL_ERROR("Failed to start worker thread.\n");
+    }
+
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_cond_destroy(&batch.jobDone);
+    pthread_mutex_destroy(&batch.lock);
+
+    free(threads);
+    free(batch.jobs);
+    free(manifest);
+}
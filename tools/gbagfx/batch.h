@@ -0,0 +1,6 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+void ConvertBatch(char *manifestPath, int threadCount, void (*convert)(int argc, char **argv));
+
+#endif // BATCH_H
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "global.h"
+#include "cache.h"
+#include "util.h"
+
+// Keeps the output of every conversion in TOOLS_CACHE_DIR, named after a hash
+// of the input file and the options it was converted with, so that assets
+// that did not change are copied instead of converted again.
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ull
+#define FNV_PRIME 0x100000001B3ull
+
+// 64-bit FNV-1a
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static uint64_t HashString(uint64_t hash, const char *s)
+{
+    // Include the terminator so that "a b" and "ab" hash differently.
+    return HashBytes(hash, s, strlen(s) + 1);
+}
+
+static const char *sCacheDir;
+static uint64_t sProgramHash;
+
+static bool HashFile(const char *path, uint64_t *hash)
+{
+    FILE *fp = fopen(path, "rb");
+
+    if (fp == NULL)
+        return false;
+
+    unsigned char buffer[0x4000];
+    size_t size;
+
+    while ((size = fread(buffer, 1, sizeof(buffer), fp)) != 0)
+        *hash = HashBytes(*hash, buffer, size);
+
+    bool success = !ferror(fp);
+
+    fclose(fp);
+    return success;
+}
+
+// Enables the cache if TOOLS_CACHE_DIR is set. Every key starts with a hash of
+// the gbagfx executable, so that entries written by a different build of
+// gbagfx are never reused. If the executable can't be read from programPath,
+// the cache stays disabled.
+void InitCache(char *programPath)
+{
+    const char *cacheDir = getenv("TOOLS_CACHE_DIR");
+
+    if (cacheDir == NULL || cacheDir[0] == 0)
+        return;
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    if (!HashFile(programPath, &hash)) {
+        char *exePath = malloc(strlen(programPath) + 5);
+
+        if (exePath == NULL)
+            FATAL_ERROR("Failed to allocate memory for cache path.\n");
+
+        sprintf(exePath, "%s.exe", programPath);
+
+        bool found = HashFile(exePath, &hash);
+
+        free(exePath);
+
+        if (!found)
+            return;
+    }
+
+    sProgramHash = hash;
+    sCacheDir = cacheDir;
+}
+
+// Returns where the output of this conversion is cached, or NULL if the cache
+// is disabled. Conversions that read other files named by their options are
+// not cached.
+char *GetCachePath(char *inputPath, char *outputFileExtension, int argc, char **argv)
+{
+    const char *cacheDir = sCacheDir;
+
+    if (cacheDir == NULL)
+        return NULL;
+
+    uint64_t hash = sProgramHash;
+
+    hash = HashString(hash, GetFileExtension(inputPath));
+    hash = HashString(hash, outputFileExtension);
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "-palette") == 0 || strcmp(argv[i], "-tilemap") == 0)
+            return NULL;
+
+        hash = HashString(hash, argv[i]);
+    }
+
+    int fileSize;
+    unsigned char *buffer = ReadWholeFile(inputPath, &fileSize);
+
+    hash = HashBytes(hash, buffer, fileSize);
+    free(buffer);
+
+    char *cachePath = malloc(strlen(cacheDir) + 32);
+
+    if (cachePath == NULL)
+        FATAL_ERROR("Failed to allocate memory for cache path.\n");
+
+    sprintf(cachePath, "%s/gbagfx-%016llx", cacheDir, (unsigned long long)hash);
+    return cachePath;
+}
+
+static bool CopyFile(char *fromPath, char *toPath)
+{
+    FILE *fp = fopen(fromPath, "rb");
+
+    if (fp == NULL)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+
+    long size = ftell(fp);
+    unsigned char *buffer = malloc(size > 0 ? size : 1);
+
+    rewind(fp);
+
+    bool success = buffer != NULL && fread(buffer, 1, size, fp) == size;
+
+    fclose(fp);
+
+    if (success) {
+        fp = fopen(toPath, "wb");
+        success = fp != NULL && fwrite(buffer, 1, size, fp) == size;
+
+        if (fp != NULL && fclose(fp) != 0)
+            success = false;
+    }
+
+    free(buffer);
+    return success;
+}
+
+bool CopyFromCache(char *cachePath, char *outputPath)
+{
+    return CopyFile(cachePath, outputPath);
+}
+
+void StoreInCache(char *outputPath, char *cachePath)
+{
+    // Write to a temporary name first so that concurrent builds never pick up
+    // a partial file. The output path keeps the names of concurrent writers
+    // apart.
+    char *tempPath = malloc(strlen(cachePath) + 32);
+
+    if (tempPath == NULL)
+        FATAL_ERROR("Failed to allocate memory for cache path.\n");
+
+    sprintf(tempPath, "%s.%016llx.tmp", cachePath, (unsigned long long)HashString(FNV_OFFSET_BASIS, outputPath));
+
+    if (!CopyFile(outputPath, tempPath) || rename(tempPath, cachePath) != 0)
+        remove(tempPath);
+
+    free(tempPath);
+}
@@ -0,0 +1,11 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+
+void InitCache(char *programPath);
+char *GetCachePath(char *inputPath, char *outputFileExtension, int argc, char **argv);
+bool CopyFromCache(char *cachePath, char *outputPath);
+void StoreInCache(char *outputPath, char *cachePath);
+
+#endif // CACHE_H
@@ -133,6 +133,85 @@ void ReadPng(char *path, struct Image *image)
     }
 }
 
+struct PngRowReader
+{
+    FILE *fp;
+    png_structp png_ptr;
+    png_infop info_ptr;
+    char *path;
+};
+
+// Unpacks rows of less than 8 bits per pixel to one byte per pixel.
+static void SetPngRowFormat(struct PngRowReader *reader)
+{
+    if (setjmp(png_jmpbuf(reader->png_ptr)))
+        FATAL_ERROR("Error reading from \"%s\".\n", reader->path);
+
+    png_set_packing(reader->png_ptr);
+    png_read_update_info(reader->png_ptr, reader->info_ptr);
+}
+
+// Opens a PNG to be read a few rows at a time by ReadPngRows. The rows are
+// left packed if the PNG already has the bit depth of the image, and have one
+// byte per pixel otherwise. Returns NULL for interlaced images, which can only
+// be read whole.
+struct PngRowReader *OpenPngRows(char *path, struct Image *image, int *rowBitDepth)
+{
+    struct PngRowReader *reader = malloc(sizeof(struct PngRowReader));
+
+    if (reader == NULL)
+        FATAL_ERROR("Failed to allocate PNG reader.\n");
+
+    reader->path = path;
+    reader->fp = PngReadOpen(path, &reader->png_ptr, &reader->info_ptr);
+
+    int bit_depth = png_get_bit_depth(reader->png_ptr, reader->info_ptr);
+    int color_type = png_get_color_type(reader->png_ptr, reader->info_ptr);
+
+    if (color_type != PNG_COLOR_TYPE_GRAY && color_type != PNG_COLOR_TYPE_PALETTE)
+        FATAL_ERROR("\"%s\" has an unsupported color type.\n", path);
+
+    if (bit_depth != 1 && bit_depth != 2 && bit_depth != 4 && bit_depth != 8)
+        FATAL_ERROR("Bit depth of image must be 1, 2, 4, or 8.\n");
+
+    if (png_get_interlace_type(reader->png_ptr, reader->info_ptr) != PNG_INTERLACE_NONE)
+    {
+        ClosePngRows(reader);
+        return NULL;
+    }
+
+    image->hasPalette = (color_type == PNG_COLOR_TYPE_PALETTE);
+    image->width = png_get_image_width(reader->png_ptr, reader->info_ptr);
+    image->height = png_get_image_height(reader->png_ptr, reader->info_ptr);
+
+    if (bit_depth == image->bitDepth) {
+        *rowBitDepth = bit_depth;
+    } else {
+        *rowBitDepth = 8;
+        SetPngRowFormat(reader);
+    }
+
+    return reader;
+}
+
+void ReadPngRows(struct PngRowReader *reader, unsigned char *pixels, int numRows)
+{
+    int rowbytes = png_get_rowbytes(reader->png_ptr, reader->info_ptr);
+
+    if (setjmp(png_jmpbuf(reader->png_ptr)))
+        FATAL_ERROR("Error reading from \"%s\".\n", reader->path);
+
+    for (int i = 0; i < numRows; i++)
+        png_read_row(reader->png_ptr, pixels + i * rowbytes, NULL);
+}
+
+void ClosePngRows(struct PngRowReader *reader)
+{
+    png_destroy_read_struct(&reader->png_ptr, &reader->info_ptr, NULL);
+    fclose(reader->fp);
+    free(reader);
+}
+
 void ReadPngPalette(char *path, struct Palette *palette)
 {
     png_structp png_ptr;
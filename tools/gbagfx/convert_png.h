@@ -8,5 +8,8 @@
 void ReadPng(char *path, struct Image *image);
 void WritePng(char *path, struct Image *image);
 void ReadPngPalette(char *path, struct Palette *palette);
+struct PngRowReader *OpenPngRows(char *path, struct Image *image, int *rowBitDepth);
+void ReadPngRows(struct PngRowReader *reader, unsigned char *pixels, int numRows);
+void ClosePngRows(struct PngRowReader *reader);
 
 #endif // CONVERT_PNG_H
@@ -8,6 +8,7 @@
 #include "global.h"
 #include "gfx.h"
 #include "util.h"
+#include "convert_png.h"
 
 #define GET_GBA_PAL_RED(x)   (((x) >>  0) & 0x1F)
 #define GET_GBA_PAL_GREEN(x) (((x) >>  5) & 0x1F)
@@ -408,35 +409,74 @@ void ReadTileImage(char *path, int tilesWidth, int metatileWidth, int metatileHe
 	free(buffer);
 }
 
-void WriteTileImage(char *path, enum NumTilesMode numTilesMode, int numTiles, int metatileWidth, int metatileHeight, struct Image *image, bool invertColors)
+static void CheckTileImageSize(int width, int height, int metatileWidth, int metatileHeight)
 {
-	int tileSize = image->bitDepth * 8;
+	if (width % 8 != 0)
+		FATAL_ERROR("The width in pixels (%d) isn't a multiple of 8.\n", width);
 
-	if (image->width % 8 != 0)
-		FATAL_ERROR("The width in pixels (%d) isn't a multiple of 8.\n", image->width);
+	if (height % 8 != 0)
+		FATAL_ERROR("The height in pixels (%d) isn't a multiple of 8.\n", height);
 
-	if (image->height % 8 != 0)
-		FATAL_ERROR("The height in pixels (%d) isn't a multiple of 8.\n", image->height);
-
-	int tilesWidth = image->width / 8;
-	int tilesHeight = image->height / 8;
+	int tilesWidth = width / 8;
+	int tilesHeight = height / 8;
 
 	if (tilesWidth % metatileWidth != 0)
 		FATAL_ERROR("The width in tiles (%d) isn't a multiple of the specified metatile width (%d)\n", tilesWidth, metatileWidth);
 
 	if (tilesHeight % metatileHeight != 0)
 		FATAL_ERROR("The height in tiles (%d) isn't a multiple of the specified metatile height (%d)\n", tilesHeight, metatileHeight);
+}
 
-	int maxNumTiles = tilesWidth * tilesHeight;
-
+static int GetNumTilesToWrite(int numTiles, int maxNumTiles)
+{
 	if (numTiles == 0)
-		numTiles = maxNumTiles;
+		return maxNumTiles;
 	else if (numTiles > maxNumTiles)
 		FATAL_ERROR("The specified number of tiles (%d) is greater than the maximum possible value (%d).\n", numTiles, maxNumTiles);
 
+	return numTiles;
+}
+
+static void WriteTiles(char *path, enum NumTilesMode numTilesMode, int numTiles, int maxNumTiles, int tileSize, unsigned char *buffer)
+{
 	int bufferSize = numTiles * tileSize;
 	int maxBufferSize = maxNumTiles * tileSize;
-	unsigned char *buffer = malloc(maxBufferSize);
+
+	bool zeroPadded = true;
+	for (int i = bufferSize; i < maxBufferSize && zeroPadded; i++) {
+		if (buffer[i] != 0)
+		{
+			switch (numTilesMode)
+			{
+			case NUM_TILES_IGNORE:
+				break;
+			case NUM_TILES_WARN:
+				fprintf(stderr, "Ignoring -num_tiles %d because tile %d contains non-transparent pixels.\n", numTiles, 1 + i / tileSize);
+				zeroPadded = false;
+				break;
+			case NUM_TILES_ERROR:
+				FATAL_ERROR("Tile %d contains non-transparent pixels.\n", 1 + i / tileSize);
+				break;
+			}
+		}
+	}
+
+	WriteWholeFile(path, buffer, zeroPadded ? bufferSize : maxBufferSize);
+}
+
+void WriteTileImage(char *path, enum NumTilesMode numTilesMode, int numTiles, int metatileWidth, int metatileHeight, struct Image *image, bool invertColors)
+{
+	int tileSize = image->bitDepth * 8;
+
+	CheckTileImageSize(image->width, image->height, metatileWidth, metatileHeight);
+
+	int tilesWidth = image->width / 8;
+	int tilesHeight = image->height / 8;
+	int maxNumTiles = tilesWidth * tilesHeight;
+
+	numTiles = GetNumTilesToWrite(numTiles, maxNumTiles);
+
+	unsigned char *buffer = malloc(maxNumTiles * tileSize);
 
 	if (buffer == NULL)
 		FATAL_ERROR("Failed to allocate memory for pixels.\n");
@@ -455,26 +495,163 @@ void WriteTileImage(char *path, enum NumTilesMode numTilesMode, int numTiles, in
 		break;
 	}
 
-	bool zeroPadded = true;
-	for (int i = bufferSize; i < maxBufferSize && zeroPadded; i++) {
-		if (buffer[i] != 0)
-		{
-			switch (numTilesMode)
-			{
-			case NUM_TILES_IGNORE:
-				break;
-			case NUM_TILES_WARN:
-				fprintf(stderr, "Ignoring -num_tiles %d because tile %d contains non-transparent pixels.\n", numTiles, 1 + i / tileSize);
-				zeroPadded = false;
-				break;
-			case NUM_TILES_ERROR:
-				FATAL_ERROR("Tile %d contains non-transparent pixels.\n", 1 + i / tileSize);
-				break;
+	WriteTiles(path, numTilesMode, numTiles, maxNumTiles, tileSize, buffer);
+
+	free(buffer);
+}
+
+// Packs a row of 8 pixels, stored one per byte, into a row of a tile. The
+// pixels are handled 8 at a time in a 64-bit word, and are truncated to the
+// bit depth like ConvertBitDepth in convert_png.c does.
+static inline uint64_t LoadPixelOctet(const unsigned char *src)
+{
+	uint64_t pixels = 0;
+
+	for (int i = 7; i >= 0; i--)
+		pixels = (pixels << 8) | src[i];
+
+	return pixels;
+}
+
+static inline void StorePixelBytes(unsigned char *dest, uint64_t pixels, int numBytes)
+{
+	for (int i = 0; i < numBytes; i++, pixels >>= 8)
+		dest[i] = (unsigned char)pixels;
+}
+
+static inline void PackTileRow1Bpp(const unsigned char *src, unsigned char *dest, bool invertColors)
+{
+	uint64_t pixels = LoadPixelOctet(src) & 0x0101010101010101;
+
+	if (invertColors)
+		pixels ^= 0x0101010101010101;
+
+	// Gathers the low bit of every byte, with the first pixel in bit 0.
+	*dest = (pixels * 0x0102040810204080) >> 56;
+}
+
+static inline void PackTileRow4Bpp(const unsigned char *src, unsigned char *dest, bool invertColors)
+{
+	uint64_t pixels = LoadPixelOctet(src) & 0x0F0F0F0F0F0F0F0F;
+
+	if (invertColors)
+		pixels ^= 0x0F0F0F0F0F0F0F0F;
+
+	// Each pair of pixels becomes one byte, with the first pixel in the low
+	// nibble, and the even bytes are then squeezed together.
+	pixels = (pixels | (pixels >> 4)) & 0x00FF00FF00FF00FF;
+	pixels = (pixels | (pixels >> 8)) & 0x0000FFFF0000FFFF;
+	pixels = pixels | (pixels >> 16);
+	StorePixelBytes(dest, pixels, 4);
+}
+
+static inline void PackTileRow8Bpp(const unsigned char *src, unsigned char *dest, bool invertColors)
+{
+	uint64_t pixels = LoadPixelOctet(src);
+
+	if (invertColors)
+		pixels = ~pixels;
+
+	StorePixelBytes(dest, pixels, 8);
+}
+
+// Rows that already have the bit depth of the tiles only need their pixels
+// reordered, as PNGs keep the first pixel in the high bits of a byte and the
+// GBA keeps it in the low bits.
+static inline void ReorderTileRow1Bpp(const unsigned char *src, unsigned char *dest, bool invertColors)
+{
+	*dest = REVERSE_BIT_ORDER(*src) ^ (invertColors ? 0xFF : 0);
+}
+
+static inline void ReorderTileRow4Bpp(const unsigned char *src, unsigned char *dest, bool invertColors)
+{
+	uint32_t pixels = src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+
+	pixels = ((pixels >> 4) & 0x0F0F0F0F) | ((pixels << 4) & 0xF0F0F0F0);
+
+	if (invertColors)
+		pixels = ~pixels;
+
+	StorePixelBytes(dest, pixels, 4);
+}
+
+// Converts a PNG to tiles while it is being decoded, one row of metatiles at a
+// time, so that the image is never held in memory in full.
+void WriteTileImageFromPng(char *inputPath, char *outputPath, enum NumTilesMode numTilesMode, int numTiles, int metatileWidth, int metatileHeight, int bitDepth)
+{
+	struct Image image;
+
+	image.bitDepth = bitDepth;
+	image.tilemap.data.affine = NULL;
+
+	int rowBitDepth;
+	struct PngRowReader *reader = OpenPngRows(inputPath, &image, &rowBitDepth);
+
+	if (reader == NULL)
+	{
+		ReadPng(inputPath, &image);
+		WriteTileImage(outputPath, numTilesMode, numTiles, metatileWidth, metatileHeight, &image, !image.hasPalette);
+		FreeImage(&image);
+		return;
+	}
+
+	int tileSize = bitDepth * 8;
+	bool invertColors = !image.hasPalette;
+
+	CheckTileImageSize(image.width, image.height, metatileWidth, metatileHeight);
+
+	int tilesWidth = image.width / 8;
+	int tilesHeight = image.height / 8;
+	int maxNumTiles = tilesWidth * tilesHeight;
+
+	numTiles = GetNumTilesToWrite(numTiles, maxNumTiles);
+
+	int metatilesWide = tilesWidth / metatileWidth;
+	int metatilesHigh = tilesHeight / metatileHeight;
+	int rowSize = tilesWidth * rowBitDepth;
+	int bandHeight = metatileHeight * 8;
+	unsigned char *band = malloc(rowSize * bandHeight);
+	unsigned char *buffer = malloc(maxNumTiles * tileSize);
+
+	if (band == NULL || buffer == NULL)
+		FATAL_ERROR("Failed to allocate memory for pixels.\n");
+
+	void (*convertTileRow)(const unsigned char *src, unsigned char *dest, bool invertColors);
+
+	switch (bitDepth) {
+	case 1:
+		convertTileRow = rowBitDepth == 1 ? ReorderTileRow1Bpp : PackTileRow1Bpp;
+		break;
+	case 4:
+		convertTileRow = rowBitDepth == 4 ? ReorderTileRow4Bpp : PackTileRow4Bpp;
+		break;
+	default:
+		convertTileRow = PackTileRow8Bpp;
+		break;
+	}
+
+	unsigned char *dest = buffer;
+
+	for (int metatileY = 0; metatileY < metatilesHigh; metatileY++) {
+		ReadPngRows(reader, band, bandHeight);
+
+		for (int metatileX = 0; metatileX < metatilesWide; metatileX++) {
+			for (int subTileY = 0; subTileY < metatileHeight; subTileY++) {
+				for (int subTileX = 0; subTileX < metatileWidth; subTileX++) {
+					int tileX = metatileX * metatileWidth + subTileX;
+					unsigned char *src = &band[subTileY * 8 * rowSize + tileX * rowBitDepth];
+
+					for (int j = 0; j < 8; j++, src += rowSize, dest += bitDepth)
+						convertTileRow(src, dest, invertColors);
+				}
 			}
 		}
 	}
 
-	WriteWholeFile(path, buffer, zeroPadded ? bufferSize : maxBufferSize);
+	ClosePngRows(reader);
+	free(band);
+
+	WriteTiles(outputPath, numTilesMode, numTiles, maxNumTiles, tileSize, buffer);
 
 	free(buffer);
 }
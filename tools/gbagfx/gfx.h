@@ -52,6 +52,7 @@ enum NumTilesMode {
 
 void ReadTileImage(char *path, int tilesWidth, int metatileWidth, int metatileHeight, struct Image *image, bool invertColors);
 void WriteTileImage(char *path, enum NumTilesMode numTilesMode, int numTiles, int metatileWidth, int metatileHeight, struct Image *image, bool invertColors);
+void WriteTileImageFromPng(char *inputPath, char *outputPath, enum NumTilesMode numTilesMode, int numTiles, int metatileWidth, int metatileHeight, int bitDepth);
 void ReadPlainImage(char *path, int dataWidth, struct Image *image, bool invertColors);
 void WritePlainImage(char *path, int dataWidth, struct Image *image, bool invertColors);
 void FreeImage(struct Image *image);
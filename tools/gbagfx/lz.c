@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "global.h"
 #include "lz.h"
 
@@ -69,85 +70,270 @@ fail:
 	FATAL_ERROR("Fatal error while decompressing LZ file.\n");
 }
 
-unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize, const int minDistance)
+#define MIN_MATCH 3
+#define MAX_MATCH 18
+#define MAX_DISTANCE 0x1000
+#define HASH_BITS 13
+
+// Finds the longest match in the window through hash chains of every position
+// that starts with the same three bytes. The chains are walked from the
+// nearest position outwards, so ties go to the shortest distance, just like
+// the brute force search this replaced, which keeps the output unchanged.
+struct MatchFinder {
+	unsigned char *src;
+	int srcSize;
+	int minDistance;
+	int *head;
+	int *prev;
+	int nextInsertPos;
+};
+
+static inline unsigned int Hash(unsigned char *src)
 {
-	if (srcSize <= 0)
-		goto fail;
+	uint32_t value = (src[0] << 16) | (src[1] << 8) | src[2];
+	return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static bool InitMatchFinder(struct MatchFinder *finder, unsigned char *src, int srcSize, int minDistance)
+{
+	finder->src = src;
+	finder->srcSize = srcSize;
+	finder->minDistance = minDistance;
+	finder->head = malloc(sizeof(int) << HASH_BITS);
+	finder->prev = malloc(sizeof(int) * srcSize);
+	finder->nextInsertPos = 0;
+
+	if (finder->head == NULL || finder->prev == NULL)
+		return false;
+
+	for (int i = 0; i < (1 << HASH_BITS); i++)
+		finder->head[i] = -1;
+
+	return true;
+}
+
+static void FreeMatchFinder(struct MatchFinder *finder)
+{
+	free(finder->head);
+	free(finder->prev);
+}
+
+// Returns the length of the longest match for srcPos, which must not be less
+// than that of the previous call.
+static int FindMatch(struct MatchFinder *finder, int srcPos, int *distance)
+{
+	unsigned char *src = finder->src;
+	int maxLength = finder->srcSize - srcPos;
+
+	if (maxLength > MAX_MATCH)
+		maxLength = MAX_MATCH;
+
+	for (; finder->nextInsertPos < srcPos; finder->nextInsertPos++) {
+		int pos = finder->nextInsertPos;
+
+		if (pos + MIN_MATCH <= finder->srcSize) {
+			unsigned int hash = Hash(&src[pos]);
+			finder->prev[pos] = finder->head[hash];
+			finder->head[hash] = pos;
+		}
+	}
+
+	if (maxLength < MIN_MATCH)
+		return 0;
+
+	int bestLength = 0;
+
+	for (int candidate = finder->head[Hash(&src[srcPos])];
+	     candidate >= 0 && srcPos - candidate <= MAX_DISTANCE;
+	     candidate = finder->prev[candidate]) {
+		// Only a longer match is of any use, so check where it would have
+		// to differ first.
+		if (srcPos - candidate < finder->minDistance
+		 || src[candidate + bestLength] != src[srcPos + bestLength])
+			continue;
 
+		int length = 0;
+
+		while (length < maxLength && src[candidate + length] == src[srcPos + length])
+			length++;
+
+		if (length > bestLength) {
+			*distance = srcPos - candidate;
+			bestLength = length;
+
+			if (length == maxLength)
+				break;
+		}
+	}
+
+	return bestLength;
+}
+
+struct LZWriter {
+	unsigned char *dest;
+	int destPos;
+	int flagsPos;
+	int tokenCount;
+};
+
+static unsigned char *InitLZWriter(struct LZWriter *writer, int srcSize)
+{
 	int worstCaseDestSize = 4 + srcSize + ((srcSize + 7) / 8);
 
 	// Round up to the next multiple of four.
 	worstCaseDestSize = (worstCaseDestSize + 3) & ~3;
 
-	unsigned char *dest = malloc(worstCaseDestSize);
+	writer->dest = malloc(worstCaseDestSize);
+	writer->destPos = 4;
+	writer->tokenCount = 0;
 
-	if (dest == NULL)
-		goto fail;
+	if (writer->dest == NULL)
+		return NULL;
 
 	// header
-	dest[0] = 0x10; // LZ compression type
-	dest[1] = (unsigned char)srcSize;
-	dest[2] = (unsigned char)(srcSize >> 8);
-	dest[3] = (unsigned char)(srcSize >> 16);
+	writer->dest[0] = 0x10; // LZ compression type
+	writer->dest[1] = (unsigned char)srcSize;
+	writer->dest[2] = (unsigned char)(srcSize >> 8);
+	writer->dest[3] = (unsigned char)(srcSize >> 16);
+
+	return writer->dest;
+}
+
+static void WriteToken(struct LZWriter *writer, bool isMatch)
+{
+	int i = writer->tokenCount++ % 8;
+
+	if (i == 0) {
+		writer->flagsPos = writer->destPos++;
+		writer->dest[writer->flagsPos] = 0;
+	}
+
+	if (isMatch)
+		writer->dest[writer->flagsPos] |= (0x80 >> i);
+}
+
+static void WriteLiteral(struct LZWriter *writer, unsigned char value)
+{
+	WriteToken(writer, false);
+	writer->dest[writer->destPos++] = value;
+}
+
+static void WriteMatch(struct LZWriter *writer, int length, int distance)
+{
+	WriteToken(writer, true);
+	length -= 3;
+	distance--;
+	writer->dest[writer->destPos++] = (length << 4) | ((unsigned int)distance >> 8);
+	writer->dest[writer->destPos++] = (unsigned char)distance;
+}
+
+static int FinishLZWriter(struct LZWriter *writer)
+{
+	// Pad to multiple of 4 bytes.
+	while (writer->destPos % 4 != 0)
+		writer->dest[writer->destPos++] = 0;
+
+	return writer->destPos;
+}
+
+unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize, const int minDistance)
+{
+	struct MatchFinder finder;
+	struct LZWriter writer;
+
+	if (srcSize <= 0
+	 || !InitMatchFinder(&finder, src, srcSize, minDistance)
+	 || InitLZWriter(&writer, srcSize) == NULL)
+		goto fail;
 
 	int srcPos = 0;
-	int destPos = 4;
 
-	for (;;) {
-		unsigned char *flags = &dest[destPos++];
-		*flags = 0;
+	while (srcPos < srcSize) {
+		int distance;
+		int length = FindMatch(&finder, srcPos, &distance);
 
-		for (int i = 0; i < 8; i++) {
-			int bestBlockDistance = 0;
-			int bestBlockSize = 0;
-			int blockDistance = minDistance;
+		if (length >= MIN_MATCH) {
+			WriteMatch(&writer, length, distance);
+			srcPos += length;
+		} else {
+			WriteLiteral(&writer, src[srcPos++]);
+		}
+	}
 
-			while (blockDistance <= srcPos && blockDistance <= 0x1000) {
-				int blockStart = srcPos - blockDistance;
-				int blockSize = 0;
+	FreeMatchFinder(&finder);
 
-				while (blockSize < 18
-				    && srcPos + blockSize < srcSize
-				    && src[blockStart + blockSize] == src[srcPos + blockSize])
-					blockSize++;
+	*compressedSize = FinishLZWriter(&writer);
+	return writer.dest;
 
-				if (blockSize > bestBlockSize) {
-					bestBlockDistance = blockDistance;
-					bestBlockSize = blockSize;
+fail:
+	FATAL_ERROR("Fatal error while compressing LZ file.\n");
+}
 
-					if (blockSize == 18)
-						break;
-				}
+// Chooses between literals and matches so that the stream is as short as
+// possible, rather than always taking the longest match. Every token costs a
+// flag bit, on top of 8 bits for a literal or 16 bits for a match.
+unsigned char *LZCompressOptimal(unsigned char *src, int srcSize, int *compressedSize, const int minDistance)
+{
+	struct MatchFinder finder;
+	struct LZWriter writer;
 
-				blockDistance++;
-			}
+	if (srcSize <= 0
+	 || !InitMatchFinder(&finder, src, srcSize, minDistance)
+	 || InitLZWriter(&writer, srcSize) == NULL)
+		goto fail;
 
-			if (bestBlockSize >= 3) {
-				*flags |= (0x80 >> i);
-				srcPos += bestBlockSize;
-				bestBlockSize -= 3;
-				bestBlockDistance--;
-				dest[destPos++] = (bestBlockSize << 4) | ((unsigned int)bestBlockDistance >> 8);
-				dest[destPos++] = (unsigned char)bestBlockDistance;
-			} else {
-				dest[destPos++] = src[srcPos++];
-			}
+	int *matchLengths = malloc(sizeof(int) * srcSize);
+	int *matchDistances = malloc(sizeof(int) * srcSize);
+	int *cost = malloc(sizeof(int) * (srcSize + 1));
 
-			if (srcPos == srcSize) {
-				// Pad to multiple of 4 bytes.
-				int remainder = destPos % 4;
+	if (matchLengths == NULL || matchDistances == NULL || cost == NULL)
+		goto fail;
 
-				if (remainder != 0) {
-					for (int i = 0; i < 4 - remainder; i++)
-						dest[destPos++] = 0;
-				}
+	for (int srcPos = 0; srcPos < srcSize; srcPos++)
+		matchLengths[srcPos] = FindMatch(&finder, srcPos, &matchDistances[srcPos]);
 
-				*compressedSize = destPos;
-				return dest;
+	FreeMatchFinder(&finder);
+
+	// Work backwards from the end, replacing each longest match length with
+	// the best length to take from that position. Any shorter prefix of the
+	// longest match is a valid match at the same distance.
+	cost[srcSize] = 0;
+
+	for (int srcPos = srcSize - 1; srcPos >= 0; srcPos--) {
+		int bestLength = 1;
+
+		cost[srcPos] = 9 + cost[srcPos + 1];
+
+		for (int length = MIN_MATCH; length <= matchLengths[srcPos]; length++) {
+			if (17 + cost[srcPos + length] < cost[srcPos]) {
+				cost[srcPos] = 17 + cost[srcPos + length];
+				bestLength = length;
 			}
 		}
+
+		matchLengths[srcPos] = bestLength;
+	}
+
+	int srcPos = 0;
+
+	while (srcPos < srcSize) {
+		int length = matchLengths[srcPos];
+
+		if (length >= MIN_MATCH) {
+			WriteMatch(&writer, length, matchDistances[srcPos]);
+			srcPos += length;
+		} else {
+			WriteLiteral(&writer, src[srcPos++]);
+		}
 	}
 
+	free(matchLengths);
+	free(matchDistances);
+	free(cost);
+
+	*compressedSize = FinishLZWriter(&writer);
+	return writer.dest;
+
 fail:
 	FATAL_ERROR("Fatal error while compressing LZ file.\n");
 }
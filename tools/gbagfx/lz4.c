@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "global.h"
+#include "lz4.h"
+
+// An LZ4-style block format that is much cheaper to decode than GBA LZ77
+// while compressing a little better. It keeps the 4-byte LZ77 header (with
+// its own type byte) so that the decompressed size can still be read from
+// bytes 1-3, followed by sequences of:
+//
+//   token          high nibble: literal count, low nibble: match length - 4
+//   [length bytes] if the literal count nibble is 15, bytes are added to it
+//                  until one is less than 255
+//   literals
+//   offset         2 bytes, little endian match distance
+//   [length bytes] as above, for the match length
+//
+// The stream ends as soon as the decompressed size has been reached, so the
+// last sequence may end after its literals.
+
+#define MIN_MATCH 4
+#define MAX_DISTANCE 0xFFFF
+#define HASH_BITS 15
+#define MAX_CHAIN 256
+
+static inline unsigned int Hash(unsigned char *src)
+{
+    uint32_t value = src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static int ReadLength(unsigned char *src, int srcSize, int *srcPos, int length)
+{
+    if (length != 15)
+        return length;
+
+    for (;;) {
+        if (*srcPos >= srcSize)
+            return -1;
+
+        unsigned char extra = src[(*srcPos)++];
+        length += extra;
+
+        if (extra != 255)
+            return length;
+    }
+}
+
+static int WriteLength(unsigned char *dest, int destPos, int length)
+{
+    if (length < 15)
+        return destPos;
+
+    length -= 15;
+
+    while (length >= 255) {
+        dest[destPos++] = 255;
+        length -= 255;
+    }
+
+    dest[destPos++] = length;
+    return destPos;
+}
+
+unsigned char *LZ4Decompress(unsigned char *src, int srcSize, int *uncompressedSize)
+{
+    if (srcSize < 4 || src[0] != LZ4_COMPRESSION_TYPE)
+        goto fail;
+
+    int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+
+    unsigned char *dest = malloc(destSize);
+
+    if (dest == NULL)
+        goto fail;
+
+    int srcPos = 4;
+    int destPos = 0;
+
+    while (destPos < destSize) {
+        if (srcPos >= srcSize)
+            goto fail;
+
+        unsigned char token = src[srcPos++];
+        int literalCount = ReadLength(src, srcSize, &srcPos, token >> 4);
+
+        if (literalCount < 0 || srcPos + literalCount > srcSize || destPos + literalCount > destSize)
+            goto fail;
+
+        for (int i = 0; i < literalCount; i++)
+            dest[destPos++] = src[srcPos++];
+
+        if (destPos == destSize)
+            break;
+
+        if (srcPos + 1 >= srcSize)
+            goto fail;
+
+        int distance = src[srcPos] | (src[srcPos + 1] << 8);
+        srcPos += 2;
+
+        int matchLength = ReadLength(src, srcSize, &srcPos, token & 0xF);
+
+        if (matchLength < 0)
+            goto fail;
+
+        matchLength += MIN_MATCH;
+
+        if (distance == 0 || distance > destPos || destPos + matchLength > destSize)
+            goto fail;
+
+        for (int i = 0; i < matchLength; i++, destPos++)
+            dest[destPos] = dest[destPos - distance];
+    }
+
+    *uncompressedSize = destSize;
+    return dest;
+
+fail:
+    FATAL_ERROR("Fatal error while decompressing LZ4 file.\n");
+}
+
+unsigned char *LZ4Compress(unsigned char *src, int srcSize, int *compressedSize, const int minDistance)
+{
+    if (srcSize <= 0)
+        goto fail;
+
+    // Incompressible data costs one length byte per 255 literals on top of the token.
+    int worstCaseDestSize = 4 + srcSize + (srcSize / 255) + 16;
+
+    // Round up to the next multiple of four.
+    worstCaseDestSize = (worstCaseDestSize + 3) & ~3;
+
+    unsigned char *dest = malloc(worstCaseDestSize);
+    int *head = malloc(sizeof(int) << HASH_BITS);
+    int *prev = malloc(sizeof(int) * srcSize);
+
+    if (dest == NULL || head == NULL || prev == NULL)
+        goto fail;
+
+    for (int i = 0; i < (1 << HASH_BITS); i++)
+        head[i] = -1;
+
+    // header
+    dest[0] = LZ4_COMPRESSION_TYPE;
+    dest[1] = (unsigned char)srcSize;
+    dest[2] = (unsigned char)(srcSize >> 8);
+    dest[3] = (unsigned char)(srcSize >> 16);
+
+    int srcPos = 0;
+    int destPos = 4;
+    int literalStart = 0;
+
+    while (srcPos < srcSize) {
+        int bestDistance = 0;
+        int bestLength = 0;
+
+        if (srcPos + MIN_MATCH <= srcSize) {
+            unsigned int hash = Hash(&src[srcPos]);
+            int candidate = head[hash];
+            int chain = 0;
+
+            while (candidate >= 0 && srcPos - candidate <= MAX_DISTANCE && chain++ < MAX_CHAIN) {
+                int distance = srcPos - candidate;
+
+                if (distance >= minDistance) {
+                    int length = 0;
+
+                    while (srcPos + length < srcSize && src[candidate + length] == src[srcPos + length])
+                        length++;
+
+                    if (length > bestLength) {
+                        bestDistance = distance;
+                        bestLength = length;
+
+                        if (srcPos + length == srcSize)
+                            break;
+                    }
+                }
+
+                candidate = prev[candidate];
+            }
+        }
+
+        if (bestLength < MIN_MATCH) {
+            if (srcPos + MIN_MATCH <= srcSize) {
+                unsigned int hash = Hash(&src[srcPos]);
+                prev[srcPos] = head[hash];
+                head[hash] = srcPos;
+            }
+            srcPos++;
+            continue;
+        }
+
+        int literalCount = srcPos - literalStart;
+        int matchLength = bestLength - MIN_MATCH;
+
+        dest[destPos++] = ((literalCount < 15 ? literalCount : 15) << 4) | (matchLength < 15 ? matchLength : 15);
+        destPos = WriteLength(dest, destPos, literalCount);
+
+        for (int i = 0; i < literalCount; i++)
+            dest[destPos++] = src[literalStart + i];
+
+        dest[destPos++] = (unsigned char)bestDistance;
+        dest[destPos++] = (unsigned char)(bestDistance >> 8);
+        destPos = WriteLength(dest, destPos, matchLength);
+
+        for (int i = 0; i < bestLength; i++, srcPos++) {
+            if (srcPos + MIN_MATCH <= srcSize) {
+                unsigned int hash = Hash(&src[srcPos]);
+                prev[srcPos] = head[hash];
+                head[hash] = srcPos;
+            }
+        }
+
+        literalStart = srcPos;
+    }
+
+    if (literalStart < srcSize) {
+        int literalCount = srcSize - literalStart;
+
+        dest[destPos++] = (literalCount < 15 ? literalCount : 15) << 4;
+        destPos = WriteLength(dest, destPos, literalCount);
+
+        for (int i = 0; i < literalCount; i++)
+            dest[destPos++] = src[literalStart + i];
+    }
+
+    // Pad to multiple of 4 bytes.
+    while (destPos % 4 != 0)
+        dest[destPos++] = 0;
+
+    free(head);
+    free(prev);
+
+    *compressedSize = destPos;
+    return dest;
+
+fail:
+    FATAL_ERROR("Fatal error while compressing LZ4 file.\n");
+}
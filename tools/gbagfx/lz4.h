@@ -0,0 +1,9 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#define LZ4_COMPRESSION_TYPE 0x40
+
+unsigned char *LZ4Decompress(unsigned char *src, int srcSize, int *uncompressedSize);
+unsigned char *LZ4Compress(unsigned char *src, int srcSize, int *compressedSize, const int minDistance);
+
+#endif // LZ4_H
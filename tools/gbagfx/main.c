@@ -10,9 +10,12 @@
 #include "convert_png.h"
 #include "jasc_pal.h"
 #include "lz.h"
+#include "lz4.h"
 #include "rl.h"
 #include "font.h"
 #include "huff.h"
+#include "cache.h"
+#include "batch.h"
 
 struct CommandHandler
 {
@@ -78,16 +81,17 @@ void ConvertPngToGba(char *inputPath, char *outputPath, struct PngToGbaOptions *
 {
     struct Image image;
 
+    if (options->isTiled)
+    {
+        WriteTileImageFromPng(inputPath, outputPath, options->numTilesMode, options->numTiles, options->metatileWidth, options->metatileHeight, options->bitDepth);
+        return;
+    }
+
     image.bitDepth = options->bitDepth;
     image.tilemap.data.affine = NULL; // initialize to NULL to avoid issues in FreeImage
 
     ReadPng(inputPath, &image);
-
-    if (options->isTiled)
-        WriteTileImage(outputPath, options->numTilesMode, options->numTiles, options->metatileWidth, options->metatileHeight, &image, !image.hasPalette);
-    else
-        WritePlainImage(outputPath, options->dataWidth, &image, !image.hasPalette);
-
+    WritePlainImage(outputPath, options->dataWidth, &image, !image.hasPalette);
     FreeImage(&image);
 }
 
@@ -426,6 +430,8 @@ void HandleLZCompressCommand(char *inputPath, char *outputPath, int argc, char *
 {
     int overflowSize = 0;
     int minDistance = 2; // default, for compatibility with LZ77UnCompVram()
+    bool useLZ4 = false;
+    bool optimal = false;
 
     for (int i = 3; i < argc; i++)
     {
@@ -457,6 +463,14 @@ void HandleLZCompressCommand(char *inputPath, char *outputPath, int argc, char *
             if (minDistance < 1)
                 FATAL_ERROR("LZ min search distance must be positive.\n");
         }
+        else if (strcmp(option, "-lz4") == 0)
+        {
+            useLZ4 = true;
+        }
+        else if (strcmp(option, "-optimal") == 0)
+        {
+            optimal = true;
+        }
         else
         {
             FATAL_ERROR("Unrecognized option \"%s\".\n", option);
@@ -473,7 +487,17 @@ void HandleLZCompressCommand(char *inputPath, char *outputPath, int argc, char *
     unsigned char *buffer = ReadWholeFileZeroPadded(inputPath, &fileSize, overflowSize);
 
     int compressedSize;
-    unsigned char *compressedData = LZCompress(buffer, fileSize + overflowSize, &compressedSize, minDistance);
+    unsigned char *compressedData;
+
+    if (useLZ4 && optimal)
+        FATAL_ERROR("\"-optimal\" is not supported with \"-lz4\".\n");
+
+    if (useLZ4)
+        compressedData = LZ4Compress(buffer, fileSize + overflowSize, &compressedSize, minDistance);
+    else if (optimal)
+        compressedData = LZCompressOptimal(buffer, fileSize + overflowSize, &compressedSize, minDistance);
+    else
+        compressedData = LZCompress(buffer, fileSize + overflowSize, &compressedSize, minDistance);
 
     compressedData[1] = (unsigned char)fileSize;
     compressedData[2] = (unsigned char)(fileSize >> 8);
@@ -492,7 +516,12 @@ void HandleLZDecompressCommand(char *inputPath, char *outputPath, int argc UNUSE
     unsigned char *buffer = ReadWholeFile(inputPath, &fileSize);
 
     int uncompressedSize;
-    unsigned char *uncompressedData = LZDecompress(buffer, fileSize, &uncompressedSize);
+    unsigned char *uncompressedData;
+
+    if (fileSize > 0 && buffer[0] == LZ4_COMPRESSION_TYPE)
+        uncompressedData = LZ4Decompress(buffer, fileSize, &uncompressedSize);
+    else
+        uncompressedData = LZDecompress(buffer, fileSize, &uncompressedSize);
 
     free(buffer);
 
@@ -586,13 +615,10 @@ void HandleHuffDecompressCommand(char *inputPath, char *outputPath, int argc UNU
     free(uncompressedData);
 }
 
-int main(int argc, char **argv)
+void Convert(int argc, char **argv)
 {
     char converted = 0;
 
-    if (argc < 3)
-        FATAL_ERROR("Usage: gbagfx INPUT_PATH OUTPUT_PATH [options...]\n");
-
     struct CommandHandler handlers[] =
     {
         { "1bpp", "png", HandleGbaToPngCommand },
@@ -661,7 +687,17 @@ int main(int argc, char **argv)
         if ((handlers[i].inputFileExtension == NULL || strcmp(handlers[i].inputFileExtension, inputFileExtension) == 0)
             && (handlers[i].outputFileExtension == NULL || strcmp(handlers[i].outputFileExtension, outputFileExtension) == 0))
         {
-            handlers[i].function(inputPath, outputPath, argc, argv);
+            char *cachePath = GetCachePath(inputPath, outputFileExtension, argc, argv);
+
+            if (cachePath == NULL || !CopyFromCache(cachePath, outputPath))
+            {
+                handlers[i].function(inputPath, outputPath, argc, argv);
+
+                if (cachePath != NULL)
+                    StoreInCache(outputPath, cachePath);
+            }
+
+            free(cachePath);
             converted = 1;
             break;
         }
@@ -672,6 +708,47 @@ int main(int argc, char **argv)
 
     if (!converted)
         FATAL_ERROR("Don't know how to convert \"%s\" to \"%s\".\n", argv[1], argv[2]);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+        FATAL_ERROR("Usage: gbagfx INPUT_PATH OUTPUT_PATH [options...]\n"
+                    "       gbagfx --batch MANIFEST_PATH [-j THREADS]\n");
+
+    InitCache(argv[0]);
+
+    if (strcmp(argv[1], "--batch") == 0)
+    {
+        int threadCount = 1;
+
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "-j") == 0)
+            {
+                if (i + 1 >= argc)
+                    FATAL_ERROR("No thread count following \"-j\".\n");
+
+                i++;
+
+                if (!ParseNumber(argv[i], NULL, 10, &threadCount))
+                    FATAL_ERROR("Failed to parse thread count.\n");
+
+                if (threadCount < 1)
+                    FATAL_ERROR("Thread count must be positive.\n");
+            }
+            else
+            {
+                FATAL_ERROR("Unrecognized option \"%s\".\n", argv[i]);
+            }
+        }
+
+        ConvertBatch(argv[2], threadCount, Convert);
+    }
+    else
+    {
+        Convert(argc, argv);
+    }
 
     return 0;
 }
@@ -25,30 +25,40 @@
 #include <cassert>
 #include <string>
 #include <set>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
 #include "main.h"
 #include "error.h"
 #include "midi.h"
 #include "agb.h"
 
-FILE* g_inputFile = nullptr;
-FILE* g_outputFile = nullptr;
+thread_local FILE* g_inputFile = nullptr;
+thread_local FILE* g_outputFile = nullptr;
 
-std::string g_asmLabel;
-int g_masterVolume = 127;
-int g_voiceGroup = 0;
-int g_priority = 0;
-int g_reverb = -1;
-int g_clocksPerBeat = 1;
-bool g_exactGateTime = false;
-bool g_compressionEnabled = true;
+thread_local std::string g_asmLabel;
+thread_local int g_masterVolume = 127;
+thread_local int g_voiceGroup = 0;
+thread_local int g_priority = 0;
+thread_local int g_reverb = -1;
+thread_local int g_clocksPerBeat = 1;
+thread_local bool g_exactGateTime = false;
+thread_local bool g_compressionEnabled = true;
+
+static const char *s_cacheDir = nullptr;
+static std::uint64_t s_programHash;
 
 [[noreturn]] static void PrintUsage()
 {
     std::printf(
         "Usage: MID2AGB name [options]\n"
+        "       MID2AGB --batch manifest [-j threads]\n"
         "\n"
         "    input_file  filename(.mid) of MIDI file\n"
         "   output_file  filename(.s) for AGB file (default:input_file)\n"
+        "      manifest  file with one set of arguments per line\n"
         "\n"
         "options  -L???  label for assembler (default:output_file)\n"
         "         -V???  master volume (default:127)\n"
@@ -127,7 +137,106 @@ static const char *GetArgument(int argc, char **argv, int& index)
     }
 }
 
-int main(int argc, char** argv)
+static bool ReadWholeFile(const std::string& filename, std::string& contents)
+{
+    std::ifstream file(filename, std::ios::binary);
+
+    if (!file)
+        return false;
+
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    contents = stream.str();
+    return true;
+}
+
+static bool CopyFile(const std::string& from, const std::string& to)
+{
+    std::string contents;
+
+    if (!ReadWholeFile(from, contents))
+        return false;
+
+    std::ofstream file(to, std::ios::binary);
+
+    if (!file.write(contents.data(), contents.size()))
+        RaiseError("failed to write \"%s\"", to.c_str());
+
+    return true;
+}
+
+// 64-bit FNV-1a
+static std::uint64_t HashBytes(std::uint64_t hash, const std::string& bytes)
+{
+    for (unsigned char c : bytes)
+    {
+        hash ^= c;
+        hash *= 0x100000001B3;
+    }
+
+    return hash;
+}
+
+// Enables the cache if TOOLS_CACHE_DIR is set. Every key starts with a hash of
+// the mid2agb executable, so that entries written by a different build of
+// mid2agb are never reused. If the executable can't be read from programPath,
+// the cache stays disabled.
+static void InitCache(const char *programPath)
+{
+    const char *cacheDir = std::getenv("TOOLS_CACHE_DIR");
+
+    if (cacheDir == nullptr || cacheDir[0] == '\0')
+        return;
+
+    std::string program;
+
+    if (!ReadWholeFile(programPath, program) && !ReadWholeFile(programPath + std::string(".exe"), program))
+        return;
+
+    s_programHash = HashBytes(0xCBF29CE484222325, program);
+    s_cacheDir = cacheDir;
+}
+
+// Returns where the output for this input and these options is cached, or an
+// empty string if the cache is disabled.
+static std::string GetCacheFilename(const std::string& inputFilename)
+{
+    if (s_cacheDir == nullptr)
+        return "";
+
+    std::string input;
+
+    if (!ReadWholeFile(inputFilename, input))
+        RaiseError("failed to open \"%s\" for reading", inputFilename.c_str());
+
+    std::ostringstream options;
+    options << g_asmLabel << ' ' << g_masterVolume << ' ' << g_voiceGroup
+            << ' ' << g_priority << ' ' << g_reverb << ' ' << g_clocksPerBeat
+            << ' ' << g_exactGateTime << ' ' << g_compressionEnabled << '\n';
+
+    std::uint64_t hash = HashBytes(s_programHash, options.str());
+    hash = HashBytes(hash, input);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/mid2agb-%016llx.s", (unsigned long long)hash);
+    return s_cacheDir + std::string(name);
+}
+
+static void StoreInCache(const std::string& outputFilename, const std::string& cacheFilename)
+{
+    // Write to a temporary name first so that a concurrent build never
+    // picks up a partial file. The output name keeps the temporary names of
+    // concurrent writers apart, whether they are threads or processes.
+    char writer[24];
+    std::snprintf(writer, sizeof(writer), ".%016llx.tmp",
+                  (unsigned long long)HashBytes(0xCBF29CE484222325, outputFilename));
+    std::string tempFilename = cacheFilename + writer;
+
+    if (CopyFile(outputFilename, tempFilename))
+        std::rename(tempFilename.c_str(), cacheFilename.c_str());
+}
+
+static void Convert(int argc, char** argv)
 {
     std::string inputFilename;
     std::string outputFilename;
@@ -211,11 +320,21 @@ int main(int argc, char** argv)
     if (g_asmLabel.empty())
         g_asmLabel = BaseName(outputFilename);
 
+    std::string cacheFilename = GetCacheFilename(inputFilename);
+
+    if (!cacheFilename.empty() && CopyFile(cacheFilename, outputFilename))
+        return;
+
     g_inputFile = std::fopen(inputFilename.c_str(), "rb");
 
     if (g_inputFile == nullptr)
         RaiseError("failed to open \"%s\" for reading", inputFilename.c_str());
 
+    // The reader seeks back and forth while pairing up notes, so buffer the
+    // whole file to keep those seeks from going to the OS.
+    std::ifstream inputStream(inputFilename, std::ios::binary | std::ios::ate);
+    std::setvbuf(g_inputFile, nullptr, _IOFBF, (std::size_t)inputStream.tellg() + BUFSIZ);
+
     g_outputFile = std::fopen(outputFilename.c_str(), "w");
 
     if (g_outputFile == nullptr)
@@ -229,5 +348,86 @@ int main(int argc, char** argv)
     std::fclose(g_inputFile);
     std::fclose(g_outputFile);
 
+    if (!cacheFilename.empty())
+        StoreInCache(outputFilename, cacheFilename);
+}
+
+// Converts every line of the manifest as if it was passed on the command line.
+// Each file is converted on its own thread, so that the per-thread conversion
+// state starts out fresh.
+static void ConvertBatch(const char *manifestFilename, int threadCount)
+{
+    std::ifstream manifest(manifestFilename);
+
+    if (!manifest)
+        RaiseError("failed to open \"%s\" for reading", manifestFilename);
+
+    std::vector<std::vector<std::string>> jobs;
+    std::string line;
+
+    while (std::getline(manifest, line))
+    {
+        std::istringstream words(line);
+        std::vector<std::string> args{"mid2agb"};
+        std::string word;
+
+        while (words >> word)
+            args.push_back(word);
+
+        if (args.size() > 1)
+            jobs.push_back(args);
+    }
+
+    std::atomic<std::size_t> nextJob(0);
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            std::size_t job;
+
+            while ((job = nextJob++) < jobs.size())
+            {
+                std::thread([&jobs, job]()
+                {
+                    std::vector<char*> argv;
+
+                    for (std::string& arg : jobs[job])
+                        argv.push_back(&arg[0]);
+
+                    Convert(argv.size(), argv.data());
+                }).join();
+            }
+        });
+    }
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+int main(int argc, char** argv)
+{
+    InitCache(argv[0]);
+
+    if (argc >= 3 && std::strcmp(argv[1], "--batch") == 0)
+    {
+        int threadCount = std::thread::hardware_concurrency();
+
+        for (int i = 3; i < argc; i++)
+        {
+            const char *arg;
+
+            if (std::strncmp(argv[i], "-j", 2) != 0 || (arg = GetArgument(argc, argv, i)) == nullptr)
+                PrintUsage();
+
+            threadCount = std::stoi(arg);
+        }
+
+        ConvertBatch(argv[2], threadCount > 0 ? threadCount : 1);
+        return 0;
+    }
+
+    Convert(argc, argv);
     return 0;
 }